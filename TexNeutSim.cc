@@ -32,6 +32,8 @@
 #include "DetectorConstruction.hh"
 #include "PhysicsList.hh"
 #include "ActionInitialization.hh"
+#include "ParameterScan.hh"
+#include "NeutronEngine.hh"
 
 int main(int argc, char** argv) {
     // Detect interactive mode (if no arguments) and define UI session
@@ -53,7 +55,14 @@ int main(int argc, char** argv) {
     PhysicsList* phys = new PhysicsList;
     runManager->SetUserInitialization(phys);
 
-    runManager->SetUserInitialization(new ActionInitialization(det));
+    // /engine/ commands: fast neutron-only transport for design screening
+    NeutronEngine* engine = new NeutronEngine(det);
+
+    runManager->SetUserInitialization(new ActionInitialization(det, phys, engine));
+
+    // /scan/ commands: design studies in one warm process
+    ParameterScan* scan = new ParameterScan;
+    scan->SetEngine(engine);
 
     // Initialize the visualization manager
     G4VisManager* visManager = nullptr;
@@ -82,6 +91,8 @@ int main(int argc, char** argv) {
     }
 
     // Job termination
+    delete scan;
+    delete engine;
     delete visManager;
     delete runManager;
 
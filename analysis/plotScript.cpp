@@ -2,28 +2,46 @@
 #include <TTree.h>
 #include <TH1D.h>
 #include <TCanvas.h>
+#include <TVector3.h>
+#include <TMath.h>
+#include <TROOT.h>
+#include <TTreeReader.h>
+#include <TChain.h>
+#include <ROOT/TThreadedObject.hxx>
+#include <ROOT/TTreeProcessorMT.hxx>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <set>
+#include <algorithm>
+
+#include "../include/EventSchema.hh"
 
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 
+// One energy histogram per scoring volume, indexed by ScoringIndex, so bars
+// and lattices are handled alike
 struct HistogramData {
-    std::vector<std::vector<TH1D*>> histograms;
+    std::vector<TH1D*> histograms;
     std::vector<TCanvas*> canvases;
 };
 
 
-struct PrimaryConditionData {
-    std::vector<TVector3> sourcePositions;
-    std::vector<TVector3> beamDirections;
-    std::vector<double> beamEnergies;
-    std::vector<std::string> beamNames;
+// Histograms of the primary conditions, filled in a single streaming pass
+// so memory use does not depend on the number of events
+struct PrimaryConditionHists {
+    TH1D* energy = nullptr;
+    TH1D* theta = nullptr;
+    TH1D* phi = nullptr;
+    TH1D* sourceX = nullptr;
+    TH1D* sourceY = nullptr;
+    TH1D* sourceZ = nullptr;
+    Long64_t entries = 0;
 };
 // Define a structure to hold the detector condition data (single entry)
 struct DetectorConditionData {
+    std::vector<int> scoringIndices;
     std::vector<std::string> scoringNames;
     std::vector<TVector3> scoringLocations;
     std::vector<std::string> scoringMaterials;
@@ -35,17 +53,19 @@ struct DetectorConditionData {
 TTree* openInputFile(const std::string& filename, const std::string& key);
 
 
-std::pair<int, int> getSimConfig(TTree* tree);
-HistogramData createHists(int numberBars, int numberCubes);
+HistogramData createHists(const DetectorConditionData& detector);
 void populateHists(TTree* tree, HistogramData& data);
-void drawHists(HistogramData& data, int numberBars, int numberCubes);
+void drawHists(HistogramData& data);
 void saveHists(const HistogramData& data, const std::string& outputFilename);
 
-PrimaryConditionData readPrimaryConditions(TTree* tree);
-void printPrimaryConditions(const PrimaryConditionData& data);
+PrimaryConditionHists streamPrimaryConditions(const std::string& filename, unsigned int nThreads = 0);
+void printPrimaryConditions(const PrimaryConditionHists& hists);
 
 DetectorConditionData readDetectorConditions(TTree* tree);
 void printDetectorConditions(const DetectorConditionData& data);
+
+void compareSpectra(const std::string& filesA, const std::string& filesB, int nBins = 100, double maxEnergy = 1.0,
+                    bool useLight = false);
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
@@ -55,29 +75,24 @@ void plotScript() {
 
     std::string dataIN = "../build/simTree_20240926_150257.root";
     // get beam conditions //
-    TTree* primaryTree = openInputFile(dataIN.c_str(), "primaryConditions");
-    if (primaryTree) {
-        PrimaryConditionData primaryData = readPrimaryConditions(primaryTree);
-        printPrimaryConditions(primaryData);
-    }
+    PrimaryConditionHists primaryHists = streamPrimaryConditions(dataIN);
+    if (primaryHists.energy) printPrimaryConditions(primaryHists);
 
 
     // get detector conditions //
-    TTree* detectorTree = openInputFile(dataIN.c_str(), "detectorConditions");
+    TTree* detectorTree = openInputFile(dataIN.c_str(), EventSchema::kGeometryTree);
     if (!detectorTree) return;
     DetectorConditionData detectorConditions = readDetectorConditions(detectorTree);
     printDetectorConditions(detectorConditions);
 
 
     // get simulated data //
-    TTree* tree = openInputFile(dataIN.c_str(), "simEvents");
+    TTree* tree = openInputFile(dataIN.c_str(), EventSchema::kEventTree);
     if (!tree) return;
-    auto [numberBars, numberCubes] = getSimConfig(tree);
-    std::cout << "numberBars = " << numberBars << std::endl;
-    std::cout << "numberCubes = " << numberCubes << std::endl;
-    HistogramData histData = createHists(numberBars, numberCubes);
+    std::cout << "scoring volumes = " << detectorConditions.scoringIndices.size() << std::endl;
+    HistogramData histData = createHists(detectorConditions);
     populateHists(tree, histData);
-    drawHists(histData, numberBars, numberCubes);
+    drawHists(histData);
     saveHists(histData, "outputHists.root");
 
 }
@@ -104,42 +119,22 @@ TTree* openInputFile(const std::string& filename, const std::string& key) {
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 
-std::pair<int, int> getSimConfig(TTree* tree) {
-    std::vector<std::string>* volumeNames = nullptr;
-    tree->SetBranchAddress("ScoringName", &volumeNames);
-    tree->GetEntry(0);
-
-    std::set<std::string> uniqueVolumeNames;
-    int maxBarIndex = -1, maxCubeIndex = -1;
-
-    for (const auto& name : *volumeNames) {
-        uniqueVolumeNames.insert(name);
-        int barIndex = -1, cubeIndex = -1;
-        if (sscanf(name.c_str(), "LogicalCrystal_%d_%d", &barIndex, &cubeIndex) == 2) {
-            maxBarIndex = std::max(maxBarIndex, barIndex);
-            maxCubeIndex = std::max(maxCubeIndex, cubeIndex);
-        }
-    }
-
-    return {maxBarIndex + 1, maxCubeIndex + 1};
-}
-
-///////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////
-
-HistogramData createHists(int numberBars, int numberCubes) {
+HistogramData createHists(const DetectorConditionData& detector) {
     HistogramData data;
-    data.histograms.resize(numberBars, std::vector<TH1D*>(numberCubes, nullptr));
-
-    for (int barIndex = 0; barIndex < numberBars; barIndex++) {
-        for (int cubeIndex = 0; cubeIndex < numberCubes; cubeIndex++) {
-            std::string histName = "hist_" + std::to_string(barIndex) + "_" + std::to_string(cubeIndex);
-            std::string histTitle = "Bar " + std::to_string(barIndex) + " Cube " + std::to_string(cubeIndex) + " Energy Deposition";
-
-            data.histograms[barIndex][cubeIndex] = new TH1D(histName.c_str(), histTitle.c_str(), 100, 0, 1);
-            data.histograms[barIndex][cubeIndex]->GetXaxis()->SetTitle("Energy (MeV)");
-            data.histograms[barIndex][cubeIndex]->GetYaxis()->SetTitle("Counts");
-        }
+    int maxIndex = -1;
+    for (int index : detector.scoringIndices) maxIndex = std::max(maxIndex, index);
+    data.histograms.assign(maxIndex + 1, nullptr);
+
+    // named after the scoring volume (LogicalCrystal_bar_cube, LatticeCrystal_x_y_z)
+    for (size_t j = 0; j < detector.scoringIndices.size(); j++) {
+        const int index = detector.scoringIndices[j];
+        if (index < 0) continue;
+        std::string histName = "hist_" + std::to_string(index);
+        std::string histTitle = detector.scoringNames[j] + " Energy Deposition";
+
+        data.histograms[index] = new TH1D(histName.c_str(), histTitle.c_str(), 100, 0, 1);
+        data.histograms[index]->GetXaxis()->SetTitle("Energy (MeV)");
+        data.histograms[index]->GetYaxis()->SetTitle("Counts");
     }
 
     return data;
@@ -149,25 +144,21 @@ HistogramData createHists(int numberBars, int numberCubes) {
 ///////////////////////////////////////////////////////////////////////
 
 void populateHists(TTree* tree, HistogramData& data) {
-    std::vector<std::string>* volumeNames = nullptr;
-    std::vector<double>* edepValues = nullptr;
-    tree->SetBranchAddress("ScoringName", &volumeNames);
-    tree->SetBranchAddress("Energy", &edepValues);
+    // the event columns are indexed like ScoringIndex
+    const std::vector<TH1D*>& histByIndex = data.histograms;
+
+    EventSchema::EventRecord event;
+    EventSchema::BindReader(tree, event);
 
     Long64_t nEntries = tree->GetEntries();
     for (Long64_t i = 0; i < nEntries; ++i) {
         tree->GetEntry(i);
 
-        for (size_t j = 0; j < volumeNames->size(); ++j) {
-            int barIndex = -1, cubeIndex = -1;
-
-            if (sscanf(volumeNames->at(j).c_str(), "LogicalCrystal_%d_%d", &barIndex, &cubeIndex) == 2) {
-                double edep = edepValues->at(j);
-                if (edep > 0.0) {
-                    data.histograms[barIndex][cubeIndex]->Fill(edep);
-                }
-            } else {
-                std::cerr << "Error parsing volume name: " << volumeNames->at(j) << std::endl;
+        const size_t n = std::min(static_cast<size_t>(event.nScoring), histByIndex.size());
+        for (size_t j = 0; j < n; ++j) {
+            double edep = event.energy[j];
+            if (edep > 0.0 && histByIndex[j]) {
+                histByIndex[j]->Fill(edep, event.crystalWeight[j]);
             }
         }
     }
@@ -176,14 +167,20 @@ void populateHists(TTree* tree, HistogramData& data) {
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 
-void drawHists(HistogramData& data, int numberBars, int numberCubes) {
-    data.canvases.resize(numberBars);
-    for (int barIndex = 0; barIndex < numberBars; barIndex++) {
-        data.canvases[barIndex] = new TCanvas(("Canvas_" + std::to_string(barIndex)).c_str(), ("Bar " + std::to_string(barIndex)).c_str(), 800, 600);
-        data.canvases[barIndex]->Divide(2, (numberCubes + 1) / 2);
-        for (int cubeIndex = 0; cubeIndex < numberCubes; cubeIndex++) {
-            data.canvases[barIndex]->cd(cubeIndex + 1);
-            data.histograms[barIndex][cubeIndex]->Draw("HIST");
+void drawHists(HistogramData& data) {
+    // six pads per canvas in scoring-index order
+    const size_t padsPerCanvas = 6;
+    const size_t nCanvases = (data.histograms.size() + padsPerCanvas - 1) / padsPerCanvas;
+    data.canvases.resize(nCanvases);
+    for (size_t c = 0; c < nCanvases; c++) {
+        data.canvases[c] = new TCanvas(("Canvas_" + std::to_string(c)).c_str(),
+                                       ("Scoring volumes " + std::to_string(c * padsPerCanvas) + "+").c_str(), 800, 600);
+        data.canvases[c]->Divide(2, 3);
+        for (size_t pad = 0; pad < padsPerCanvas && c * padsPerCanvas + pad < data.histograms.size(); pad++) {
+            TH1D* hist = data.histograms[c * padsPerCanvas + pad];
+            if (!hist) continue;
+            data.canvases[c]->cd(pad + 1);
+            hist->Draw("HIST");
         }
     }
 }
@@ -193,10 +190,8 @@ void drawHists(HistogramData& data, int numberBars, int numberCubes) {
 
 void saveHists(const HistogramData& data, const std::string& outputFilename) {
     TFile outputFile(outputFilename.c_str(), "RECREATE");
-    for (const auto& histRow : data.histograms) {
-        for (const auto& hist : histRow) {
-            hist->Write();
-        }
+    for (const auto& hist : data.histograms) {
+        if (hist) hist->Write();
     }
 }
 
@@ -204,83 +199,83 @@ void saveHists(const HistogramData& data, const std::string& outputFilename) {
 ///////////////////////////////////////////////////////////////////////
 
 
-PrimaryConditionData readPrimaryConditions(TTree* tree) {
-    PrimaryConditionData data;
-    
-    double beamEnergies;
-    std::string* beamName = new std::string(); 
-    std::tuple<double, double, double>* beamDirection = new std::tuple<double, double, double>(); // Initialize tuple pointers
-    std::tuple<double, double, double>* sourcePosition = new std::tuple<double, double, double>(); // Initialize tuple pointers
-
-    tree->SetBranchAddress("SourcePosition", &sourcePosition);
-    tree->SetBranchAddress("BeamDirection", &beamDirection);
-    tree->SetBranchAddress("BeamEnergy", &beamEnergies);
-    tree->SetBranchAddress("BeamName", &beamName); // std::string
-
-    Long64_t nEntries = tree->GetEntries(); // Get the number of entries in the tree
-    for (Long64_t i = 0; i < nEntries; ++i) {
-        tree->GetEntry(i); // Get the entry data for the current index
-        
-        data.beamEnergies.push_back(beamEnergies);
-        data.beamNames.push_back(*beamName); // Dereference the string pointer
-        
-        data.sourcePositions.push_back(TVector3(std::get<0>(*sourcePosition), std::get<1>(*sourcePosition), std::get<2>(*sourcePosition)));
-        data.beamDirections.push_back(TVector3(std::get<0>(*beamDirection), std::get<1>(*beamDirection), std::get<2>(*beamDirection)));
-    }
-
-    delete beamName;
-    delete beamDirection;
-    delete sourcePosition;
-
-    return data; // Return the filled data structure
+PrimaryConditionHists streamPrimaryConditions(const std::string& filename, unsigned int nThreads) {
+    // TTreeProcessorMT does not report a missing file or tree: check first,
+    // an empty result (null histograms) means nothing was read
+    if (!openInputFile(filename, EventSchema::kPrimaryTree)) return PrimaryConditionHists();
+
+    // nThreads == 0 lets ROOT pick the pool size
+    ROOT::EnableImplicitMT(nThreads);
+
+    // one private copy of each histogram per worker, merged at the end
+    ROOT::TThreadedObject<TH1D> energyHist("BeamEnergyHist", "Beam Energy Histogram;Energy (MeV);Counts", 100, 0, 10); // Adjust the range as needed
+    ROOT::TThreadedObject<TH1D> thetaHist("BeamThetaHist", "Beam Theta Histogram;Theta (degrees);Counts", 100, 0, 180);
+    ROOT::TThreadedObject<TH1D> phiHist("BeamPhiHist", "Beam Phi Histogram;Phi (degrees);Counts", 100, 0, 360);
+    ROOT::TThreadedObject<TH1D> sourceXHist("SourceXHist", "Source X Position Histogram;X (units);Counts", 100, -10, 10); // Adjust range as needed
+    ROOT::TThreadedObject<TH1D> sourceYHist("SourceYHist", "Source Y Position Histogram;Y (units);Counts", 100, -10, 10); // Adjust range as needed
+    ROOT::TThreadedObject<TH1D> sourceZHist("SourceZHist", "Source Z Position Histogram;Z (units);Counts", 100, -10, 10); // Adjust range as needed
+
+    ROOT::TTreeProcessorMT processor(filename, EventSchema::kPrimaryTree);
+    processor.Process([&](TTreeReader& reader) {
+        // bind the task's tree straight into a stack record: no per-entry allocation
+        TTree* tree = reader.GetTree();
+        EventSchema::PrimaryRecord primary;
+        EventSchema::BindReader(tree, primary);
+
+        auto energy = energyHist.Get();
+        auto theta = thetaHist.Get();
+        auto phi = phiHist.Get();
+        auto sourceX = sourceXHist.Get();
+        auto sourceY = sourceYHist.Get();
+        auto sourceZ = sourceZHist.Get();
+
+        const auto range = reader.GetEntriesRange();
+        for (Long64_t entry = range.first; entry < range.second; ++entry) {
+            tree->GetEntry(entry);
+            const TVector3 beamDirection(primary.direction);
+            energy->Fill(primary.energy);
+            theta->Fill(beamDirection.Theta() * 180.0 / TMath::Pi()); // Convert to degrees
+            phi->Fill(beamDirection.Phi() * 180.0 / TMath::Pi());     // Convert to degrees
+            sourceX->Fill(primary.position[0]);
+            sourceY->Fill(primary.position[1]);
+            sourceZ->Fill(primary.position[2]);
+        }
+    });
+
+    // Merge() hands back a shared_ptr; keep clones that outlive the threaded objects
+    PrimaryConditionHists hists;
+    hists.energy  = static_cast<TH1D*>(energyHist.Merge()->Clone());
+    hists.theta   = static_cast<TH1D*>(thetaHist.Merge()->Clone());
+    hists.phi     = static_cast<TH1D*>(phiHist.Merge()->Clone());
+    hists.sourceX = static_cast<TH1D*>(sourceXHist.Merge()->Clone());
+    hists.sourceY = static_cast<TH1D*>(sourceYHist.Merge()->Clone());
+    hists.sourceZ = static_cast<TH1D*>(sourceZHist.Merge()->Clone());
+    hists.entries = static_cast<Long64_t>(hists.energy->GetEntries());
+
+    ROOT::DisableImplicitMT();
+    return hists;
 }
 
-void printPrimaryConditions(const PrimaryConditionData& data) {
+void printPrimaryConditions(const PrimaryConditionHists& hists) {
     std::cout << "Primary Conditions:\n";
-    
-    TH1D* energyHistogram = new TH1D("BeamEnergyHist", "Beam Energy Histogram;Energy (MeV);Counts", 100, 0, 10); // Adjust the range as needed
-    TH1D* thetaHistogram = new TH1D("BeamThetaHist", "Beam Theta Histogram;Theta (degrees);Counts", 100, 0, 180);
-    TH1D* phiHistogram = new TH1D("BeamPhiHist", "Beam Phi Histogram;Phi (degrees);Counts", 100, 0, 360);
-    
-    TH1D* sourceXHistogram = new TH1D("SourceXHist", "Source X Position Histogram;X (units);Counts", 100, -10, 10); // Adjust range as needed
-    TH1D* sourceYHistogram = new TH1D("SourceYHist", "Source Y Position Histogram;Y (units);Counts", 100, -10, 10); // Adjust range as needed
-    TH1D* sourceZHistogram = new TH1D("SourceZHist", "Source Z Position Histogram;Z (units);Counts", 100, -10, 10); // Adjust range as needed
-
-    for (size_t i = 0; i < data.beamEnergies.size(); ++i) {
-        // Fill energy histogram
-        energyHistogram->Fill(data.beamEnergies[i]);
-        
-        // Calculate theta and phi from the beam direction
-        const TVector3& beamDirection = data.beamDirections[i];
-        double theta = beamDirection.Theta() * 180.0 / TMath::Pi(); // Convert to degrees
-        double phi = beamDirection.Phi() * 180.0 / TMath::Pi();   // Convert to degrees
-        
-        // Fill theta and phi histograms
-        thetaHistogram->Fill(theta);
-        phiHistogram->Fill(phi);
-
-        // Fill source position histograms
-        const TVector3& sourcePosition = data.sourcePositions[i];
-        sourceXHistogram->Fill(sourcePosition.X());
-        sourceYHistogram->Fill(sourcePosition.Y());
-        sourceZHistogram->Fill(sourcePosition.Z());
-    }
+    std::cout << "  Entries: " << hists.entries << "\n";
+    std::cout << "  Mean Energy: " << hists.energy->GetMean() << " MeV\n";
 
     // Create a canvas and draw all histograms
     TCanvas* canvas = new TCanvas("cb", "Beam Energy Histogram", 800, 600);
     canvas->Divide(2, 3); // Divide the canvas into 2x3 grid to fit all histograms
     canvas->cd(1);
-    energyHistogram->Draw();
+    hists.energy->Draw();
     canvas->cd(2);
-    thetaHistogram->Draw();
+    hists.theta->Draw();
     canvas->cd(3);
-    phiHistogram->Draw();
+    hists.phi->Draw();
     canvas->cd(4);
-    sourceXHistogram->Draw();
+    hists.sourceX->Draw();
     canvas->cd(5);
-    sourceYHistogram->Draw();
+    hists.sourceY->Draw();
     canvas->cd(6);
-    sourceZHistogram->Draw();
+    hists.sourceZ->Draw();
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -289,37 +284,20 @@ void printPrimaryConditions(const PrimaryConditionData& data) {
 DetectorConditionData readDetectorConditions(TTree* tree) {
     DetectorConditionData data;
 
-    std::tuple<double, double, double>* scoringLocationPtr = new std::tuple<double, double, double>(); // Initialize tuple pointers
-    std::tuple<double, double, double>* scoringSizePtr = new std::tuple<double, double, double>(); // Initialize tuple pointers
-    std::string* scoringNamePtr = new std::string(); 
-    std::string* scoringMaterialPtr = new std::string(); 
-
-
-    tree->SetBranchAddress("ScoringName", &scoringNamePtr);
-    tree->SetBranchAddress("ScoringLocation", &scoringLocationPtr);
-    tree->SetBranchAddress("ScoringMaterial", &scoringMaterialPtr);
-    tree->SetBranchAddress("ScoringSize", &scoringSizePtr);
+    EventSchema::GeometryRecord record;
+    EventSchema::BindReader(tree, record);
 
-    Long64_t nEntries = tree->GetEntries(); // Get the number of entries in the tree
-    
+    Long64_t nEntries = tree->GetEntries(); // one entry per scoring volume
     for (Long64_t i = 0; i < nEntries; ++i) {
-        tree->GetEntry(i); // Only need the first entry (index 0)
-
-        data.scoringNames.push_back(   *scoringNamePtr );
-        data.scoringMaterials.push_back(  *scoringMaterialPtr   );
-        data.scoringLocations.push_back(TVector3(std::get<0>(*scoringLocationPtr), std::get<1>(*scoringLocationPtr), std::get<2>(*scoringLocationPtr)));
-        data.scoringSizes.push_back(TVector3(std::get<0>(*scoringSizePtr), std::get<1>(*scoringSizePtr), std::get<2>(*scoringSizePtr)));
+        tree->GetEntry(i);
 
+        data.scoringIndices.push_back(record.index);
+        data.scoringNames.push_back(record.name);
+        data.scoringMaterials.push_back(record.material);
+        data.scoringLocations.push_back(TVector3(record.location));
+        data.scoringSizes.push_back(TVector3(record.size));
     }
 
-
-    tree->GetEntry(0); // Only need the first entry (index 0)
-
-    delete scoringNamePtr;
-    delete scoringLocationPtr;
-    delete scoringMaterialPtr;
-    delete scoringSizePtr;
-
     return data;
 }
 
@@ -340,4 +318,68 @@ void printDetectorConditions(const DetectorConditionData& data) {
                   << data.scoringSizes[i].Y() << ", " 
                   << data.scoringSizes[i].Z() << ")\n";
     }
-}
\ No newline at end of file
+}
+
+// Compare per-crystal energy spectra of two runs, e.g. two cut settings.
+// Each argument is a file name or a TChain wildcard such as
+// "simTree_*_run2_t*.root" that picks up every worker file of one run.
+// Prints the weighted efficiency, mean and the Kolmogorov and chi2
+// probabilities per crystal. useLight compares the quenched light (MeVee)
+// instead of the deposited energy (MeV).
+void compareSpectra(const std::string& filesA, const std::string& filesB, int nBins, double maxEnergy,
+                    bool useLight) {
+    TChain chainA(EventSchema::kEventTree), chainB(EventSchema::kEventTree);
+    if (chainA.Add(filesA.c_str()) == 0 || chainB.Add(filesB.c_str()) == 0) {
+        std::cerr << "Error: no input files for " << filesA << " or " << filesB << std::endl;
+        return;
+    }
+
+    // every worker file carries the same geometry tree: read the first one
+    TTree* geometry = openInputFile(chainA.GetListOfFiles()->At(0)->GetTitle(), EventSchema::kGeometryTree);
+    if (!geometry) return;
+    DetectorConditionData detector = readDetectorConditions(geometry);
+    const size_t nScoring = detector.scoringNames.size();
+
+    auto fill = [&](TChain& chain, const char* tag) {
+        std::vector<TH1D*> hists(nScoring, nullptr);
+        for (size_t j = 0; j < nScoring; ++j) {
+            std::string name = std::string(tag) + "_" + detector.scoringNames[j];
+            hists[j] = new TH1D(name.c_str(), detector.scoringNames[j].c_str(), nBins, 0, maxEnergy);
+            hists[j]->Sumw2();
+        }
+        EventSchema::EventRecord event;
+        EventSchema::BindReader(&chain, event);
+        Long64_t nEntries = chain.GetEntries();
+        for (Long64_t i = 0; i < nEntries; ++i) {
+            chain.GetEntry(i);
+            const size_t n = std::min(static_cast<size_t>(event.nScoring), nScoring);
+            for (size_t j = 0; j < n; ++j) {
+                if (event.energy[j] > 0.0) {
+                    hists[j]->Fill(useLight ? event.light[j] : event.energy[j], event.crystalWeight[j]);
+                }
+            }
+        }
+        return hists;
+    };
+    std::vector<TH1D*> histsA = fill(chainA, "A");
+    std::vector<TH1D*> histsB = fill(chainB, "B");
+
+    std::cout << "========== Spectra: A = " << filesA << ", B = " << filesB << " ==========" << std::endl;
+    std::cout << "events A: " << chainA.GetEntries() << ", events B: " << chainB.GetEntries() << std::endl;
+    // efficiency = sum of crystal weights per primary, unbiased with or without biasing
+    const double eventsA = chainA.GetEntries(), eventsB = chainB.GetEntries();
+    std::cout << "crystal  effA  effB  meanA  meanB  P(KS)  P(chi2)" << std::endl;
+    for (size_t j = 0; j < nScoring; ++j) {
+        TH1D* a = histsA[j];
+        TH1D* b = histsB[j];
+        double pKS = (a->GetEntries() > 0 && b->GetEntries() > 0) ? a->KolmogorovTest(b) : -1.;
+        double pChi2 = (a->GetEntries() > 0 && b->GetEntries() > 0) ? a->Chi2Test(b, "WW") : -1.;
+        std::cout << detector.scoringNames[j] << "  " << a->GetSumOfWeights() / eventsA << "  " << b->GetSumOfWeights() / eventsB
+                  << "  " << a->GetMean() << "  " << b->GetMean()
+                  << "  " << pKS << "  " << pChi2 << std::endl;
+    }
+    std::cout << "=================================================================" << std::endl;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
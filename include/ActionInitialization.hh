@@ -33,6 +33,8 @@
 #include "G4VUserActionInitialization.hh"
 
 class DetectorConstruction;
+class PhysicsList;
+class NeutronEngine;
 
 /// Action initialization class.
 ///
@@ -40,7 +42,8 @@ class DetectorConstruction;
 class ActionInitialization : public G4VUserActionInitialization
 {
   public:
-    ActionInitialization(DetectorConstruction* detector);
+    ActionInitialization(DetectorConstruction* detector, const PhysicsList* physics,
+                         NeutronEngine* engine = nullptr);
     virtual ~ActionInitialization();
 
     virtual void BuildForMaster() const;
@@ -48,6 +51,8 @@ class ActionInitialization : public G4VUserActionInitialization
    
   private:
     DetectorConstruction* fDetector;
+    const PhysicsList* fPhysicsList;
+    NeutronEngine* fEngine;
 };
 
 #endif
@@ -0,0 +1,76 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file CrystalBiasingOperator.hh
+/// \brief Definition of the CrystalBiasingOperator class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef CrystalBiasingOperator_h
+#define CrystalBiasingOperator_h 1
+
+#include "G4VBiasingOperator.hh"
+#include "globals.hh"
+#include <map>
+
+class DetectorConstruction;
+class G4BOptnChangeCrossSection;
+class G4BiasingProcessInterface;
+class G4ParticleDefinition;
+
+/// Scales the cross section of every neutron process while the neutron is
+/// in a crystal (the operator is attached to the crystal logical volumes).
+/// The generic biasing framework keeps the track weight consistent: a
+/// neutron that interacts with a scale s > 1 carries weight ~1/s, one that
+/// crosses without interacting is weighted up accordingly.
+/// The scale factor is read from DetectorConstruction at every step, so
+/// /detector/biasScale can change between runs.
+
+class CrystalBiasingOperator : public G4VBiasingOperator
+{
+  public:
+    CrystalBiasingOperator(const DetectorConstruction* detector);
+    virtual ~CrystalBiasingOperator();
+
+    virtual void StartRun();
+
+  private:
+    virtual G4VBiasingOperation* ProposeOccurenceBiasingOperation(const G4Track* track,
+                                                                 const G4BiasingProcessInterface* callingProcess);
+    virtual G4VBiasingOperation* ProposeFinalStateBiasingOperation(const G4Track*, const G4BiasingProcessInterface*)
+    { return nullptr; }
+    virtual G4VBiasingOperation* ProposeNonPhysicsBiasingOperation(const G4Track*, const G4BiasingProcessInterface*)
+    { return nullptr; }
+
+    const DetectorConstruction* fDetector;
+    const G4ParticleDefinition* fNeutron;
+    std::map<const G4BiasingProcessInterface*, G4BOptnChangeCrossSection*> fOperations;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
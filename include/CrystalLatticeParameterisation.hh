@@ -0,0 +1,66 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file CrystalLatticeParameterisation.hh
+/// \brief Definition of the CrystalLatticeParameterisation class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef CrystalLatticeParameterisation_h
+#define CrystalLatticeParameterisation_h 1
+
+#include "G4VPVParameterisation.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4VPhysicalVolume;
+
+/// Places nx * ny * nz identical crystals on a regular grid centred on the
+/// mother volume. The copy number is the crystal ID:
+///   copyNo = ix + nx * (iy + ny * iz)
+/// so the grid position is recovered analytically, without any lookup table.
+
+class CrystalLatticeParameterisation : public G4VPVParameterisation
+{
+  public:
+    CrystalLatticeParameterisation(G4int nx, G4int ny, G4int nz, G4double pitch);
+    virtual ~CrystalLatticeParameterisation();
+
+    virtual void ComputeTransformation(const G4int copyNo, G4VPhysicalVolume* physVol) const;
+
+    G4ThreeVector GetPosition(G4int copyNo) const;
+    void GetIndices(G4int copyNo, G4int& ix, G4int& iy, G4int& iz) const;
+    G4int GetNumberOfCrystals() const { return fNx * fNy * fNz; }
+
+  private:
+    G4int fNx, fNy, fNz;
+    G4double fPitch;     // crystal size plus the grease gap
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
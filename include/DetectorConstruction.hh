@@ -5,11 +5,16 @@
 #include "globals.hh"
 #include "G4ThreeVector.hh"
 #include <vector>
+#include <unordered_set>
 #include "TVector3.h"
 class G4LogicalVolume;
 class G4VPhysicalVolume;
+class G4VTouchable;
 class G4Material;
 class DetectorMessenger;
+class DetectorResponse;
+class PhaseSpaceRecorder;
+class CrystalLatticeParameterisation;
 
 class DetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -30,6 +35,16 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     void SetBarSpacing(G4double spacing);
     void SetCoverThickness(G4double thickness);
     void SetWorldSize(G4double size);
+    void SetCheckOverlaps(G4bool flag);
+    void SetGeometryCacheDir(const G4String& dir);
+    void SetNestedBars(G4bool flag);
+    void SetSmartless(G4double smartless);
+    void SetUseLattice(G4bool flag);
+    void SetLatticeSize(G4int nx, G4int ny, G4int nz);
+    void SetRecoilFastSim(G4bool flag);
+    void SetRecoilSafetyFraction(G4double fraction);
+    void SetBiasMode(const G4String& mode);
+    void SetBiasScale(G4double scale);
 
     // Getters
     G4double GetWorldSize() const { return fWorldLength; }
@@ -41,13 +56,42 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     G4int GetCrystalsPerBar() const { return fCrystalsPerBar; }
     G4double GetCrystalSize() const{return fCrystalSize;}
     G4double GetGreaseThickness() const{return fGreaseThickness;}
+    G4double GetCoverThickness() const{return fCoverThickness;}
     G4double GetBarSpacing() const {return fBarSpacing;}
+    G4bool GetUseLattice() const {return fUseLattice;}
+    G4bool GetBuiltLattice() const {return fBuiltLattice;}
+    G4double GetRecoilSafetyFraction() const {return fRecoilSafetyFraction;}
+    G4double GetBiasScale() const {return fBiasScale;}
 
+    // scintillator response of the crystals (quenching), shared by all threads
+    DetectorResponse* GetResponse() const {return fResponse;}
+    // phase-space recording at an envelope around the detector
+    const PhaseSpaceRecorder* GetPhaseSpaceRecorder() const {return fPhaseSpaceRecorder;}
+
+    // sphere enclosing all crystals and their covers, for source biasing
+    const G4ThreeVector& GetBoundingCentre() const {return fBoundingCentre;}
+    G4double GetBoundingRadius() const {return fBoundingRadius;}
+
+    // Scoring: dense index in [0, GetNumberOfScoringVolumes()), -1 if the
+    // touchable is not a crystal. Bars: barIndex*crystalsPerBar + crystalIndex,
+    // lattice: the replica copy number.
+    G4int GetNumberOfScoringVolumes() const { return static_cast<G4int>(scoringHandles.size()); }
+    G4int GetScoringIndex(const G4VTouchable* touchable) const;
+
+
+    // Regions carrying their own production cuts (see PhysicsList)
+    static constexpr const char* kCrystalRegion = "Crystals";
+    static constexpr const char* kGreaseRegion  = "Grease";
+    static constexpr const char* kCoverRegion   = "Cover";
 
     // Main construction method
     virtual G4VPhysicalVolume* Construct();
+    virtual void ConstructSDandField();
 
     void PrintParameters();
+    void UpdateGeometry();
+    void BenchmarkNavigation(G4int nRays);
+    void RunOverlapCheck(G4int resolution);
 
     G4int itt =0;
   private:
@@ -57,11 +101,22 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     void PlaceBars();
     void ConstructBar(G4ThreeVector position, G4int barIndex);
     G4LogicalVolume*  CreateCover(G4ThreeVector position, G4int barIndex);
-    void CreateCrystal(G4LogicalVolume* parentVolume, G4ThreeVector position, G4int barIndex, G4int crystalIndex);
+    G4LogicalVolume*  CreateNestedCover(G4ThreeVector position, G4int barIndex);
+    void CreateCrystal(G4LogicalVolume* parentVolume, G4ThreeVector position, G4ThreeVector globalPosition, G4int barIndex, G4int crystalIndex);
     void CreateGrease(G4LogicalVolume* parentVolume, G4ThreeVector position, G4int barIndex, G4int greaseIndex);
     void CreatePanel(G4ThreeVector position, G4double sizeX, G4double sizeY, G4double sizeZ, const std::string& name);
+    void PlaceLattice();
+
+    // GDML geometry cache, keyed by a hash of the geometry parameters
+    G4String GetGeometryCacheFile() const;
+    G4bool ReadGeometryCache(const G4String& fileName);
+    void WriteGeometryCache(const G4String& fileName);
+    void FillScoringTables(G4LogicalVolume* mother, G4ThreeVector offset);
     
     void Clean();
+    void ResetVolumeLists();
+    void AssignRegions();
+    void ComputeBoundingSphere();
 
     // World
     G4LogicalVolume* fLWorld = nullptr;
@@ -93,8 +148,40 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     G4int fNumberOfBars = 0;
     G4double fBarSpacing = 0.0;
 
+    // Startup
+    G4bool fCheckOverlaps = true;
+    G4String fGeometryCacheDir;   // empty: no cache
+
+    // Bar layout: nested cover/envelope mothers instead of a boolean cover
+    G4bool fNestedBars = false;
+    G4double fSmartless = 2.0;    // voxels per daughter, Geant4 default
+
+    // 3D lattice: one shared crystal volume, parameterised placement
+    G4bool fUseLattice = false;
+    G4int fLatticeNx = 1;
+    G4int fLatticeNy = 1;
+    G4int fLatticeNz = 1;
+    CrystalLatticeParameterisation* fLatticeParam = nullptr;
+
+    // recoil fast simulation in the crystal region (needs /physics/enable fastSimulation)
+    G4bool fRecoilFastSim = false;
+    G4double fRecoilSafetyFraction = 0.5;   // range must be below this fraction of the safety
+
+    // neutron interaction biasing in crystals (needs /physics/enable biasing)
+    G4String fBiasMode = "none";    // none, scale or force
+    G4double fBiasScale = 1.0;      // cross-section factor in "scale" mode
+
+    // crystal logical volumes, for the scoring lookup
+    std::unordered_set<const G4LogicalVolume*> fCrystalVolumes;
+    G4bool fBuiltLattice = false; // layout of the geometry actually built
+
+    G4ThreeVector fBoundingCentre;
+    G4double fBoundingRadius = 0.;
+
     // Detector Messenger
     DetectorMessenger* fDetectorMessenger = nullptr;
+    DetectorResponse* fResponse = nullptr;
+    PhaseSpaceRecorder* fPhaseSpaceRecorder = nullptr;
 
     void UpdateLogicalVolumes(std::vector<G4LogicalVolume*>& logicalVolumes, G4Material* newMaterial);
 
@@ -110,8 +197,6 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     //G4int getNumberScoringVolumes()const{return fNumberOfBars *fCrystalsPerBar }; 
     //std::vector<G4LogicalVolume*> GetScoringVolumes() const { return fLCrystals; }
 
-
-    //void RebuildGeometry()
 ;};
 
 #endif
@@ -9,6 +9,10 @@ class G4UIdirectory;
 class G4UIcmdWithAnInteger;
 class G4UIcmdWithAString;
 class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
 
 class DetectorMessenger: public G4UImessenger
 {
@@ -36,6 +40,20 @@ class DetectorMessenger: public G4UImessenger
     G4UIcmdWithADoubleAndUnit* fCoverThicknessCmd;
     G4UIcmdWithADoubleAndUnit* fWorldSizeCmd;
 
+    G4UIcmdWithoutParameter* fUpdateCmd;
+    G4UIcmdWithABool*     fCheckOverlapsCmd;
+    G4UIcommand*          fRunOverlapCheckCmd;
+    G4UIcmdWithAString*   fGeometryCacheCmd;
+    G4UIcmdWithABool*     fNestedBarsCmd;
+    G4UIcmdWithADouble*   fSmartlessCmd;
+    G4UIcmdWithABool*     fUseLatticeCmd;
+    G4UIcommand*          fLatticeSizeCmd;
+    G4UIcmdWithAnInteger* fBenchmarkNavigationCmd;
+    G4UIcmdWithABool*     fRecoilFastSimCmd;
+    G4UIcmdWithADouble*   fRecoilSafetyFractionCmd;
+    G4UIcmdWithAString*   fBiasModeCmd;
+    G4UIcmdWithADouble*   fBiasScaleCmd;
+
 
     
 
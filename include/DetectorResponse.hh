@@ -0,0 +1,271 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file DetectorResponse.hh
+/// \brief Definition of the DetectorResponse class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef DetectorResponse_h
+#define DetectorResponse_h 1
+
+#include "LightCollectionMap.hh"
+#include "EventBuilder.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+#include <vector>
+
+class DetectorConstruction;
+struct CrystalDeposits;
+class DetectorResponseMessenger;
+class G4ParticleDefinition;
+class G4Material;
+
+/// Scintillator response of the crystals, applied to the deposits without
+/// optical photon tracking. Light is in MeVee: an electron track of energy
+/// E gives E when its quenching is negligible.
+///
+/// Quenching follows Birks/Chou along the track,
+///   dL/dx = (dE/dx) / (1 + kB dE/dx + C (dE/dx)^2),
+/// with kB and C set per species (/response/birks).
+///
+/// Optionally the light is converted to detected photoelectrons with a
+/// LightCollectionMap of the current bar geometry (/response/lce/), built
+/// once by optical ray tracing and cached on disk.
+///
+/// For pulse-shape discrimination the light is also kept per species. The
+/// pulse of each species is a fast and a slow exponential; the tail/total
+/// ratio of a crystal is the light-weighted mix of the species' tail and
+/// total integrals (/response/psd/).
+///
+/// Owned by the DetectorConstruction and shared read-only by all threads;
+/// change it between runs only.
+
+class DetectorResponse
+{
+  public:
+    DetectorResponse(const DetectorConstruction* detector);
+   ~DetectorResponse();
+
+    enum Species { kElectron = 0, kProton, kAlpha, kIon, kNumberOfSpecies };
+    static Species GetSpecies(const G4ParticleDefinition* particle);
+    static const char* GetSpeciesName(Species species);
+
+    // kB in mm/MeV, C in (mm/MeV)^2
+    void SetBirks(Species species, G4double kB, G4double C);
+    void SetQuenching(G4bool flag) { fQuenching = flag; fStoppingLight.clear(); }
+    void Print() const;
+
+    // 1 / (1 + kB dE/dx + C (dE/dx)^2)
+    G4double Quench(Species species, G4double dEdx) const;
+
+    // light of one step, from its mean dE/dx; deposits without a step
+    // length (local deposits) are not quenched. Neutral particles count as
+    // electrons, so their local deposits are electron-equivalent.
+    G4double StepLight(Species species, G4double edep, G4double stepLength) const;
+
+    // light of one step of a charged particle slowing from preEnergy to
+    // postEnergy. Range-limited steps of hadrons and ions, where dE/dx
+    // changes along the step, take L(preEnergy) - L(postEnergy) from the
+    // cumulative tables of PrepareStoppingLight, scaled to the local
+    // deposit; all other steps use the mean dE/dx as above.
+    G4double StepLight(const G4ParticleDefinition* particle, const G4Material* material, Species species,
+                       G4double edep, G4double stepLength, G4double preEnergy, G4double postEnergy) const;
+
+    // light of a particle stopping in the material, integrated over its
+    // slowing down with the Geant4 stopping powers; interpolated in the
+    // tables of PrepareStoppingLight when it has one for the pair
+    G4double StoppingLight(const G4ParticleDefinition* particle, const G4Material* material,
+                           G4double energy) const;
+
+    // on the master before the events: cumulative light tables of the
+    // recoil nuclei and alphas in every crystal material, for the current
+    // quenching constants
+    void PrepareStoppingLight();
+
+    // Light collection
+    void SetLightCollection(G4bool flag) { fLightCollection = flag; }
+    void SetMapCacheDir(const G4String& dir) { fMapCacheDir = dir; }
+    void SetMapBins(G4int bins) { fMapBins = bins; }
+    void SetMapPhotonsPerBin(G4int photons) { fMapPhotonsPerBin = photons; }
+    void SetCrystalIndex(G4double index) { fOptics.crystalIndex = index; }
+    void SetGreaseIndex(G4double index) { fOptics.greaseIndex = index; }
+    void SetCoverReflectivity(G4double reflectivity) { fOptics.coverReflectivity = reflectivity; }
+    void SetAttenuationLength(G4double length) { fOptics.attenuationLength = length; }
+    void SetPhotonsPerMeV(G4double yield) { fPhotonsPerMeV = yield; }
+    void SetDetectionEfficiency(G4double efficiency) { fDetectionEfficiency = efficiency; }
+
+    // on the master before the events: reads or builds the map of the
+    // current geometry; rebuild ignores the cache
+    void PrepareLightCollection(G4bool rebuild = false);
+    G4bool UseLightCollection() const { return fLightCollection && fMap.IsValid(); }
+
+    // mean number of photoelectrons for light emitted at a point given in
+    // the frame of the crystal
+    G4double PhotoElectronMean(G4int scoringIndex, const G4ThreeVector& local, G4double light) const;
+
+    // Pulse shape: decay times, tail gate [tailStart, gate] from the pulse
+    // start and the slow-component light fraction of each species
+    void SetDecayTimes(G4double fast, G4double slow);
+    void SetGate(G4double tailStart, G4double gate);
+    void SetSlowFraction(Species species, G4double fraction);
+
+    // end of event: samples the photoelectrons and sets the tail/total
+    // ratio of every crystal, binomially smeared by the photoelectrons
+    // when the light collection is on
+    void FinishEvent(CrystalDeposits& deposits) const;
+
+    // Readout of a time-structured source (/source/activity): pile-up,
+    // dead time and random coincidences, see EventBuilder
+    void SetEventBuilding(G4bool flag) { fBuilder.enabled = flag; }
+    void SetIntegrationTime(G4double time) { fBuilder.integrationTime = time; }
+    void SetDeadTime(G4double time) { fBuilder.deadTime = time; }
+    void SetCoincidenceWindow(G4double time) { fBuilder.coincidenceWindow = time; }
+    const EventBuilder::Settings& GetBuilderSettings() const { return fBuilder; }
+
+  private:
+    void UpdatePulseIntegrals();
+    G4double IntegrateStoppingLight(const G4ParticleDefinition* particle, const G4Material* material,
+                                    G4double energy) const;
+
+    // light / energy on a log energy grid, for one particle in one material
+    struct StoppingLightTable {
+      const G4ParticleDefinition* particle;
+      const G4Material* material;
+      std::vector<G4double> lightRatio;
+    };
+    const StoppingLightTable* FindStoppingLight(const G4ParticleDefinition* particle,
+                                                const G4Material* material) const;
+    // cumulative light L(energy), energy <= fLightTableMax
+    G4double TableLight(const StoppingLightTable& table, G4double energy) const;
+
+    struct Birks {
+      G4double kB;
+      G4double C;
+    };
+
+    Birks  fBirks[kNumberOfSpecies];
+    G4bool fQuenching = true;
+    G4int  fIntegrationSteps = 64;
+    std::vector<StoppingLightTable> fStoppingLight;
+    G4double fLightTableMin = 100. * eV;
+    G4double fLightTableMax = 100. * MeV;
+    G4int    fLightTableBins = 256;
+    // a step is range limited when the particle stops in it or loses more
+    // than this fraction of its energy
+    G4double fRangeLimitedLoss = 0.1;
+
+    const DetectorConstruction* fDetector;
+    LightCollectionMap fMap;
+    LightCollectionMap::Optics fOptics;
+    G4bool   fLightCollection = false;
+    G4String fMapCacheDir = "lceMaps";
+    G4int    fMapBins = 10;
+    G4int    fMapPhotonsPerBin = 2000;
+    G4double fPhotonsPerMeV = 27000.;        // scintillation yield per MeVee
+    G4double fDetectionEfficiency = 0.25;    // photodetector
+
+    G4double fFastTime;
+    G4double fSlowTime;
+    G4double fTailStart;
+    G4double fGate;
+    G4double fSlowFraction[kNumberOfSpecies];
+    G4double fTailIntegral[kNumberOfSpecies];    // per unit light
+    G4double fTotalIntegral[kNumberOfSpecies];
+
+    EventBuilder::Settings fBuilder;
+
+    DetectorResponseMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+// Per-event deposits of the crystals, indexed by the scoring index;
+// speciesLight is [index * kNumberOfSpecies + species]. Each deposit also
+// adds its track weight times its energy and light, so biased tracks are
+// scored with their own weight. With keepTimes (event building) every
+// deposit is kept with its time as well, to be split into pulses.
+
+struct CrystalDeposits
+{
+  std::vector<G4double> edep;
+  std::vector<G4double> light;            // quenched, MeVee
+  std::vector<G4double> photoElectrons;   // mean during the event, sampled at its end
+  std::vector<G4double> speciesLight;
+  std::vector<G4double> tailToTotal;      // set at the end of the event
+  std::vector<G4double> weightedEdep;     // sum of track weight * edep
+  std::vector<G4double> weightedLight;    // sum of track weight * light
+
+  struct TimedDeposit {
+    G4double time;
+    G4int    index;
+    G4double edep;
+    G4double light;
+    G4double photoElectrons;   // mean
+  };
+  std::vector<TimedDeposit> timed;
+  G4bool keepTimes = false;
+
+  void Reset(std::size_t n, G4bool withTimes = false)
+  {
+    edep.assign(n, 0.);
+    light.assign(n, 0.);
+    photoElectrons.assign(n, 0.);
+    speciesLight.assign(n * DetectorResponse::kNumberOfSpecies, 0.);
+    tailToTotal.assign(n, 0.);
+    weightedEdep.assign(n, 0.);
+    weightedLight.assign(n, 0.);
+    timed.clear();
+    keepTimes = withTimes;
+  }
+
+  void Add(G4int index, G4int species, G4double energy, G4double quenched, G4double meanPhotoElectrons,
+           G4double globalTime, G4double weight)
+  {
+    if (index < 0 || index >= static_cast<G4int>(edep.size())) return;
+    if (keepTimes) timed.push_back({globalTime, index, energy, quenched, meanPhotoElectrons});
+    edep[index] += energy;
+    light[index] += quenched;
+    photoElectrons[index] += meanPhotoElectrons;
+    speciesLight[index * DetectorResponse::kNumberOfSpecies + species] += quenched;
+    weightedEdep[index] += weight * energy;
+    weightedLight[index] += weight * quenched;
+  }
+
+  // deposit-weighted mean track weight of a crystal, fallback if it has no deposit
+  G4double EdepWeight(std::size_t index, G4double fallback) const
+  {
+    return edep[index] > 0. ? weightedEdep[index] / edep[index] : fallback;
+  }
+  G4double LightWeight(std::size_t index, G4double fallback) const
+  {
+    return light[index] > 0. ? weightedLight[index] / light[index] : fallback;
+  }
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef DetectorResponseMessenger_h
+#define DetectorResponseMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class DetectorResponse;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithABool;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+
+class DetectorResponseMessenger: public G4UImessenger
+{
+  public:
+    DetectorResponseMessenger(DetectorResponse*);
+    virtual ~DetectorResponseMessenger();
+
+    virtual void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+    DetectorResponse* fResponse;
+
+    G4UIdirectory*           fResponseDir;
+
+    G4UIcommand*             fBirksCmd;
+    G4UIcmdWithABool*        fQuenchingCmd;
+    G4UIcmdWithoutParameter* fPrintCmd;
+
+    G4UIdirectory*             fLceDir;
+    G4UIcmdWithABool*          fLceEnableCmd;
+    G4UIcmdWithoutParameter*   fLceBuildCmd;
+    G4UIcmdWithAString*        fLceCacheDirCmd;
+    G4UIcmdWithAnInteger*      fLceBinsCmd;
+    G4UIcmdWithAnInteger*      fLcePhotonsCmd;
+    G4UIcmdWithADouble*        fCrystalIndexCmd;
+    G4UIcmdWithADouble*        fGreaseIndexCmd;
+    G4UIcmdWithADouble*        fCoverReflectivityCmd;
+    G4UIcmdWithADoubleAndUnit* fAttenuationCmd;
+    G4UIcmdWithADouble*        fYieldCmd;
+    G4UIcmdWithADouble*        fDetectionEfficiencyCmd;
+
+    G4UIdirectory*             fPsdDir;
+    G4UIcommand*               fSlowFractionCmd;
+    G4UIcommand*               fDecayTimesCmd;
+    G4UIcommand*               fGateCmd;
+
+    G4UIdirectory*             fBuilderDir;
+    G4UIcmdWithABool*          fBuilderEnableCmd;
+    G4UIcmdWithADoubleAndUnit* fIntegrationTimeCmd;
+    G4UIcmdWithADoubleAndUnit* fDeadTimeCmd;
+    G4UIcmdWithADoubleAndUnit* fCoincidenceWindowCmd;
+};
+
+#endif
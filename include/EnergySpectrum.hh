@@ -0,0 +1,107 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file EnergySpectrum.hh
+/// \brief Definition of the EnergySpectrum class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef EnergySpectrum_h
+#define EnergySpectrum_h 1
+
+#include "globals.hh"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/// Source energy spectrum as a piecewise-linear density on a grid of
+/// points. Building the spectrum compiles the bin probabilities into an
+/// alias table (Walker/Vose), so Sample() costs two random numbers, one
+/// table lookup and the inversion of one linear segment, whatever the
+/// number of bins.
+///
+/// Analytic spectra are tabulated on a fine uniform grid:
+///   Watt       f(E) ~ exp(-E/a) sinh(sqrt(b E))   (Cf-252: a = 1.025 MeV, b = 2.926 /MeV)
+///   Maxwellian f(E) ~ sqrt(E) exp(-E/T)           (Cf-252: T = 1.42 MeV)
+/// The built-in AmBe spectrum is a coarse digitisation of the ISO 8529-1
+/// shape (mean 4.3 MeV against 4.16 MeV for the standard); load the
+/// tabulated standard with ReadFile() where it matters.
+
+class EnergySpectrum
+{
+  public:
+    EnergySpectrum() = default;
+   ~EnergySpectrum() = default;
+
+    // false, keeping the previous table, if the result is not a spectrum
+    G4bool BuildWatt(G4double a, G4double b, G4double maxEnergy, G4int points);
+    G4bool BuildMaxwellian(G4double temperature, G4double maxEnergy, G4int points);
+    G4bool BuildAmBe();
+
+    // two columns per line, energy in MeV and density (any normalisation);
+    // '#' starts a comment. false if the file holds no usable table.
+    G4bool ReadFile(const G4String& fileName);
+
+    // energies increasing, densities >= 0 and not all zero
+    G4bool Build(const std::vector<G4double>& energy, const std::vector<G4double>& density,
+                 const G4String& name);
+
+    G4bool IsValid() const { return !fProbability.empty(); }
+    const G4String& GetName() const { return fName; }
+    G4double GetMeanEnergy() const { return fMeanEnergy; }
+    G4double GetMinEnergy() const { return fEnergy.empty() ? 0. : fEnergy.front(); }
+    G4double GetMaxEnergy() const { return fEnergy.empty() ? 0. : fEnergy.back(); }
+
+    G4double Sample() const;
+    // from two uniform numbers drawn elsewhere, e.g. in bulk
+    G4double Sample(G4double u, G4double r) const;
+
+    // the alias table on its own, for discrete distributions: weights >= 0,
+    // not all zero; SampleAlias() returns an index from one uniform number
+    static void BuildAliasTable(const std::vector<G4double>& weights,
+                                std::vector<G4double>& probability, std::vector<G4int>& alias);
+    static std::size_t SampleAlias(const std::vector<G4double>& probability,
+                                   const std::vector<G4int>& alias, G4double u)
+    {
+      std::size_t n = probability.size();
+      u *= n;
+      std::size_t i = std::min(static_cast<std::size_t>(u), n - 1);
+      return u - i < probability[i] ? i : static_cast<std::size_t>(alias[i]);
+    }
+
+  private:
+    G4String fName;
+    std::vector<G4double> fEnergy;        // grid points
+    std::vector<G4double> fDensity;       // at the grid points
+    std::vector<G4double> fProbability;   // alias table, one entry per bin
+    std::vector<G4int>    fAlias;
+    G4double fMeanEnergy = 0.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -36,10 +36,12 @@
 //#include "RunAction.hh"
 #include "G4ThreeVector.hh"
 #include "G4UserEventAction.hh"
+#include "DetectorResponse.hh"
 #include "globals.hh"
 #include <vector>
 
 class RunAction;
+struct PhaseSpaceRecord;
 class DetectorConstruction;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -54,14 +56,34 @@ class EventAction : public G4UserEventAction
     virtual void BeginOfEventAction(const G4Event* event);
     virtual void EndOfEventAction(const G4Event* event);
     void Clear();
-    void AddEdep(const G4String& volName, G4double edep);
+    // each deposit carries the weight of the track that made it
+    void AddEdep(G4int scoringIndex, G4int species, G4double edep, G4double light, G4double photoElectrons,
+                 G4double time, G4double weight) {
+      fDeposits.Add(scoringIndex, species, edep, light, photoElectrons, time, weight);
+    }
+    // global time of the primary vertex; kill times are counted from it
+    G4double GetEmissionTime() const { return fEmissionTime; }
+    void CountStep() { ++fNumberOfSteps; }
+    void CountLocalDeposit() { ++fNumberOfLocalDeposits; }
+
+    enum KillPolicy { kKillEnvelope = 0, kKillTime, kKillEnergy, kNumberOfKillPolicies };
+    void CountKilled(KillPolicy policy) { ++fNumberOfKilled[policy]; }
+
+    void RecordPhaseSpace(const PhaseSpaceRecord& record);
   
   private:
     RunAction* fRunAction;
     DetectorConstruction* fDetector;
 
-    
-    std::map<G4String, G4double> fEdepMap;
+    // deposits per scoring volume, indexed by DetectorConstruction::GetScoringIndex
+    CrystalDeposits fDeposits;
+    G4double fSourceWeight = 1.;   // weight of the primary vertex
+    G4double fEmissionTime = 0.;
+
+    // tracking cost of the event
+    G4long fNumberOfSteps = 0;
+    G4long fNumberOfLocalDeposits = 0;
+    G4long fNumberOfKilled[kNumberOfKillPolicies] = {0, 0, 0};
 
 };
 
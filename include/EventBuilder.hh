@@ -0,0 +1,151 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file EventBuilder.hh
+/// \brief Definition of the EventBuilder class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef EventBuilder_h
+#define EventBuilder_h 1
+
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+#include <deque>
+#include <functional>
+#include <vector>
+
+/// Readout of a time-structured source. Every G4Event contributes one
+/// pulse per crystal and integration window its deposits fall in, so a
+/// delayed deposit of the same primary (a capture gamma) makes a pulse of
+/// its own; with a source activity the primaries are spread over time, so
+/// pulses of different primaries overlap.
+///
+/// Pulses are kept in a per-thread min-heap on time and processed in
+/// order once no later event can precede them, i.e. once they are older
+/// than the emission time of the current primary:
+///   - a pulse opens an integration window in its crystal; pulses in the
+///     same crystal inside the window are summed into it (pile-up)
+///   - the crystal is then dead for the dead time from the window start
+///     (non-paralysable); pulses arriving meanwhile are lost
+///   - closed windows starting within the coincidence window of the first
+///     one form a built event; one with pulses of more than one primary
+///     is a random coincidence
+///
+/// The builder does no transport and keeps only the pulses still inside
+/// the horizon, so its cost per event is a few heap operations.
+
+class EventBuilder
+{
+  public:
+    struct Settings {
+      G4bool   enabled = false;
+      G4double integrationTime = 200. * ns;
+      G4double deadTime = 500. * ns;
+      G4double coincidenceWindow = 100. * ns;
+    };
+
+    struct Pulse {
+      G4double time;
+      G4int    crystal;
+      G4int    primary;
+      G4double edep;
+      G4double light;
+      G4double photoElectrons;
+    };
+
+    struct BuiltEvent {
+      G4double time = 0.;
+      std::vector<G4double> edep;
+      std::vector<G4double> light;
+      std::vector<G4double> photoElectrons;
+      std::vector<G4int>    pulses;      // per crystal, > 1 is pile-up
+      G4int numberOfPrimaries = 0;       // > 1 is a random coincidence
+    };
+
+    struct Counters {
+      G4long pulses = 0;
+      G4long piledUp = 0;            // summed into an open window
+      G4long lost = 0;               // arrived during the dead time
+      G4long builtEvents = 0;
+      G4long randomCoincidences = 0;
+    };
+
+    EventBuilder() = default;
+   ~EventBuilder() = default;
+
+    // new run: empty buffers and counters; output receives every built event
+    void Start(const Settings& settings, G4int numberOfCrystals, std::function<void(const BuiltEvent&)> output);
+
+    void AddPulse(const Pulse& pulse);
+    // every pulse earlier than horizon is final
+    void Process(G4double horizon);
+    // end of run: everything is final
+    void Flush();
+
+    const Counters& GetCounters() const { return fCounters; }
+    const Settings& GetSettings() const { return fSettings; }
+
+  private:
+    struct Window {
+      G4bool   open = false;
+      G4double start = 0.;
+      G4double deadUntil = -1.;
+      G4double edep = 0.;
+      G4double light = 0.;
+      G4double photoElectrons = 0.;
+      G4int    pulses = 0;
+      std::vector<G4int> primaries;
+    };
+
+    struct Hit {
+      G4int    crystal;
+      G4double start;
+      G4double edep;
+      G4double light;
+      G4double photoElectrons;
+      G4int    pulses;
+      std::vector<G4int> primaries;
+    };
+
+    void ReadOut(const Pulse& pulse);
+    void CloseWindows(G4double horizon);
+    void Build(G4double horizon);
+
+    Settings fSettings;
+    std::function<void(const BuiltEvent&)> fOutput;
+    std::vector<Pulse>  fPending;    // min-heap on time
+    std::vector<Window> fWindows;    // per crystal
+    std::deque<G4int>   fOpen;       // crystals with an open window, in start order
+    std::deque<Hit>     fHits;       // closed windows, in start order
+    BuiltEvent fEvent;
+    Counters   fCounters;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
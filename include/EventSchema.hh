@@ -0,0 +1,267 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file EventSchema.hh
+/// \brief Header-only description of the TexNeutSim output trees
+//
+// Every record lists its branches exactly once in ForEachField(). The
+// simulation binds them with BindWriter(), the analysis with BindReader(),
+// so both sides agree on names and types by construction. All branches are
+// plain leaf lists pointing into buffers owned by the record: reading an
+// entry copies straight into those buffers with no conversion and no
+// per-entry allocation.
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef EventSchema_h
+#define EventSchema_h 1
+
+#include "TTree.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace EventSchema
+{
+  // Tree names
+  constexpr const char* kEventTree    = "simEvents";
+  constexpr const char* kPrimaryTree  = "primaryConditions";
+  constexpr const char* kGeometryTree = "detectorConditions";
+  constexpr const char* kBuiltTree    = "builtEvents";
+
+  constexpr int kNameLength = 64;
+
+  // light columns per species: electron, proton, alpha, ion (DetectorResponse::Species)
+  constexpr int kNumberOfSpecies = 4;
+
+  inline void CopyName(Char_t* dest, const std::string& src)
+  {
+    std::strncpy(dest, src.c_str(), kNameLength - 1);
+    dest[kNameLength - 1] = '\0';
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  // One entry per event: energy deposited in each scoring volume, its
+  // quenched light output, the detected photoelectrons (0 without a light
+  // collection map), the light per species and the synthetic tail/total
+  // PSD ratio, indexed like the entries of the geometry tree. The PSD
+  // columns are single precision.
+  // Weight is the source weight of the event (1 without source biasing) and
+  // CrystalWeight that of each scoring volume: the mean track weight of its
+  // deposits, weighted by energy. Under track biasing (/detector/biasMode)
+  // the volumes of one event carry different weights and Weight is not an
+  // unbiased event weight, so spectra, counts and efficiencies must be
+  // scored per volume with CrystalWeight.
+
+  struct EventRecord
+  {
+    Int_t nScoring = 0;
+    Double_t weight = 1.;
+    std::vector<Double_t> energy;   // [nScoring] MeV
+    std::vector<Double_t> crystalWeight;    // [nScoring]
+    std::vector<Double_t> light;    // [nScoring] MeVee
+    std::vector<Double_t> photoElectrons;   // [nScoring]
+    std::vector<Float_t>  speciesLight;     // [nScoring][kNumberOfSpecies] MeVee
+    std::vector<Float_t>  tailToTotal;      // [nScoring]
+
+    // Must be called before binding: the branch keeps the buffer address
+    void Reserve(Int_t n)
+    {
+      if (static_cast<Int_t>(energy.size()) < n) energy.resize(n, 0.0);
+      if (static_cast<Int_t>(crystalWeight.size()) < n) crystalWeight.resize(n, 0.0);
+      if (static_cast<Int_t>(light.size()) < n) light.resize(n, 0.0);
+      if (static_cast<Int_t>(photoElectrons.size()) < n) photoElectrons.resize(n, 0.0);
+      if (static_cast<Int_t>(tailToTotal.size()) < n) {
+        speciesLight.resize(static_cast<std::size_t>(n) * kNumberOfSpecies, 0.f);
+        tailToTotal.resize(n, 0.f);
+      }
+    }
+
+    // one event of per-crystal accumulators (edep, weightedEdep, light,
+    // photoElectrons, speciesLight, tailToTotal vectors, MeV)
+    template <class Deposits> void Fill(const Deposits& deposits)
+    {
+      nScoring = static_cast<Int_t>(deposits.edep.size());
+      std::copy(deposits.edep.begin(), deposits.edep.end(), energy.begin());
+      for (Int_t i = 0; i < nScoring; i++) {
+        crystalWeight[i] = deposits.edep[i] > 0. ? deposits.weightedEdep[i] / deposits.edep[i] : 0.;
+      }
+      std::copy(deposits.light.begin(), deposits.light.end(), light.begin());
+      std::copy(deposits.photoElectrons.begin(), deposits.photoElectrons.end(), photoElectrons.begin());
+      std::copy(deposits.speciesLight.begin(), deposits.speciesLight.end(), speciesLight.begin());
+      std::copy(deposits.tailToTotal.begin(), deposits.tailToTotal.end(), tailToTotal.begin());
+    }
+
+    template <class F> void ForEachField(F&& f)
+    {
+      f("NScoring", &nScoring,     "NScoring/I");
+      f("Weight",   &weight,       "Weight/D");
+      f("Energy",   energy.data(), "Energy[NScoring]/D");
+      f("CrystalWeight", crystalWeight.data(), "CrystalWeight[NScoring]/D");
+      f("Light",    light.data(),  "Light[NScoring]/D");
+      f("PhotoElectrons", photoElectrons.data(), "PhotoElectrons[NScoring]/D");
+      f("SpeciesLight", speciesLight.data(), "SpeciesLight[NScoring][4]/F");
+      f("TailToTotal",  tailToTotal.data(),  "TailToTotal[NScoring]/F");
+    }
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  // One entry per built event of a time-structured source: the crystal
+  // windows that opened within the coincidence window, with the number of
+  // pulses summed in each (> 1: pile-up) and of source primaries behind
+  // them (> 1: random coincidence). Analog sources only: no weight.
+
+  struct BuiltEventRecord
+  {
+    Double_t time = 0.;             // ns, start of the first window
+    Int_t nScoring = 0;
+    Int_t nPrimaries = 0;
+    std::vector<Double_t> energy;   // [nScoring] MeV
+    std::vector<Double_t> light;    // [nScoring] MeVee
+    std::vector<Double_t> photoElectrons;   // [nScoring]
+    std::vector<Int_t>    pulses;           // [nScoring]
+
+    void Reserve(Int_t n)
+    {
+      if (static_cast<Int_t>(energy.size()) < n) energy.resize(n, 0.0);
+      if (static_cast<Int_t>(light.size()) < n) light.resize(n, 0.0);
+      if (static_cast<Int_t>(photoElectrons.size()) < n) photoElectrons.resize(n, 0.0);
+      if (static_cast<Int_t>(pulses.size()) < n) pulses.resize(n, 0);
+    }
+
+    // one EventBuilder::BuiltEvent (time in ns, energies in MeV)
+    template <class Built> void Fill(const Built& built)
+    {
+      time = built.time;
+      nScoring = static_cast<Int_t>(built.edep.size());
+      nPrimaries = built.numberOfPrimaries;
+      std::copy(built.edep.begin(), built.edep.end(), energy.begin());
+      std::copy(built.light.begin(), built.light.end(), light.begin());
+      std::copy(built.photoElectrons.begin(), built.photoElectrons.end(), photoElectrons.begin());
+      std::copy(built.pulses.begin(), built.pulses.end(), pulses.begin());
+    }
+
+    template <class F> void ForEachField(F&& f)
+    {
+      f("Time",       &time,       "Time/D");
+      f("NScoring",   &nScoring,   "NScoring/I");
+      f("NPrimaries", &nPrimaries, "NPrimaries/I");
+      f("Energy",     energy.data(), "Energy[NScoring]/D");
+      f("Light",      light.data(),  "Light[NScoring]/D");
+      f("PhotoElectrons", photoElectrons.data(), "PhotoElectrons[NScoring]/D");
+      f("Pulses",     pulses.data(), "Pulses[NScoring]/I");
+    }
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  // One entry per primary particle. Weight is the source biasing weight
+  // (1 for an analog source, 0 for a skipped event).
+  // In fission mode one entry per fission: the direction is the fragment
+  // axis, the energy the summed neutron energy, the PDG code Cf-252's and
+  // the multiplicities are filled (0 otherwise).
+
+  struct PrimaryRecord
+  {
+    Double_t position[3]  = {0., 0., 0.};   // mm
+    Double_t direction[3] = {0., 0., 1.};
+    Double_t energy = 0.;                   // MeV
+    Int_t    pdg = 0;
+    Double_t weight = 1.;
+    Int_t    fissionNeutrons = 0;
+    Int_t    fissionGammas = 0;
+
+    template <class F> void ForEachField(F&& f)
+    {
+      f("SourcePosition", position,  "SourcePosition[3]/D");
+      f("BeamDirection",  direction, "BeamDirection[3]/D");
+      f("BeamEnergy",     &energy,   "BeamEnergy/D");
+      f("BeamPDG",        &pdg,      "BeamPDG/I");
+      f("SourceWeight",   &weight,   "SourceWeight/D");
+      f("FissionNeutrons", &fissionNeutrons, "FissionNeutrons/I");
+      f("FissionGammas",   &fissionGammas,   "FissionGammas/I");
+    }
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  // One entry per scoring volume, written once per run.
+
+  struct GeometryRecord
+  {
+    Int_t    index = 0;
+    Char_t   name[kNameLength] = {0};
+    Char_t   material[kNameLength] = {0};
+    Double_t location[3] = {0., 0., 0.};    // mm
+    Double_t size[3] = {0., 0., 0.};        // mm
+
+    template <class F> void ForEachField(F&& f)
+    {
+      f("ScoringIndex",    &index,   "ScoringIndex/I");
+      f("ScoringName",     name,     "ScoringName/C");
+      f("ScoringMaterial", material, "ScoringMaterial/C");
+      f("ScoringLocation", location, "ScoringLocation[3]/D");
+      f("ScoringSize",     size,     "ScoringSize[3]/D");
+    }
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  // Bindings
+
+  template <class Record> void BindWriter(TTree* tree, Record& record)
+  {
+    record.ForEachField([tree](const char* name, void* address, const char* leaflist) {
+      tree->Branch(name, address, leaflist);
+    });
+  }
+
+  template <class Record> void BindReader(TTree* tree, Record& record)
+  {
+    record.ForEachField([tree](const char* name, void* address, const char*) {
+      tree->SetBranchAddress(name, address);
+    });
+  }
+
+  // Size the variable-length buffers for the largest entry in the tree
+  inline void BindReader(TTree* tree, EventRecord& record)
+  {
+    record.Reserve(static_cast<Int_t>(tree->GetMaximum("NScoring")));
+    record.ForEachField([tree](const char* name, void* address, const char*) {
+      tree->SetBranchAddress(name, address);
+    });
+  }
+
+  inline void BindReader(TTree* tree, BuiltEventRecord& record)
+  {
+    record.Reserve(static_cast<Int_t>(tree->GetMaximum("NScoring")));
+    record.ForEachField([tree](const char* name, void* address, const char*) {
+      tree->SetBranchAddress(name, address);
+    });
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file FissionSource.hh
+/// \brief Definition of the FissionSource class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef FissionSource_h
+#define FissionSource_h 1
+
+#include "EnergySpectrum.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+#include <vector>
+
+/// Prompt neutrons and gammas of one Cf-252 spontaneous fission, sampled
+/// together so that coincidences between them come out right:
+///   - neutron multiplicity from the evaluated P(nu) table (mean 3.78)
+///   - each neutron evaporates isotropically, with a Maxwellian energy of
+///     temperature a, in the frame of one of the two fragments, which fly
+///     apart back to back along a random axis with Ef = a^2 b / 4 per
+///     nucleon. In the lab this is exactly the Watt spectrum (a = 1.025 MeV,
+///     b = 2.926 /MeV), and neutrons of one fission are correlated in angle
+///     through the shared axis.
+///   - gamma multiplicity Poisson with mean 8.3, isotropic, energies from
+///     the Valentine fit of the prompt spectrum (0.085 to 8 MeV)
+/// All tables are alias tables, and the random numbers of one fission are
+/// drawn in two bulk calls.
+
+class FissionSource
+{
+  public:
+    struct Fission {
+      G4ThreeVector axis;                       // light fragment direction
+      std::vector<G4ThreeVector> neutronDirection;
+      std::vector<G4double>      neutronEnergy;
+      std::vector<G4ThreeVector> gammaDirection;
+      std::vector<G4double>      gammaEnergy;
+    };
+
+    FissionSource() = default;
+   ~FissionSource() = default;
+
+    // maxEnergy and points: grid of the fragment-frame neutron spectrum
+    G4bool BuildCf252(G4double maxEnergy, G4int points);
+
+    G4bool IsValid() const { return !fNeutronProbability.empty(); }
+    G4double GetMeanNeutrons() const { return fMeanNeutrons; }
+    G4double GetMeanGammas() const { return fMeanGammas; }
+
+    // fills fission; no gammas unless withGammas
+    void Sample(Fission& fission, G4bool withGammas);
+
+  private:
+    static G4ThreeVector Isotropic(G4double u, G4double v);
+
+    std::vector<G4double> fNeutronProbability;   // alias table over nu
+    std::vector<G4int>    fNeutronAlias;
+    std::vector<G4double> fGammaProbability;     // alias table over the gamma count
+    std::vector<G4int>    fGammaAlias;
+    EnergySpectrum fCentreOfMass;    // neutron energy in the fragment frame
+    EnergySpectrum fGammaSpectrum;
+    G4double fFragmentEnergy = 0.;   // kinetic energy per nucleon
+    G4double fMeanNeutrons = 0.;
+    G4double fMeanGammas = 0.;
+    std::vector<G4double> fUniform;  // bulk random numbers
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
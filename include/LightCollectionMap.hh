@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file LightCollectionMap.hh
+/// \brief Definition of the LightCollectionMap class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef LightCollectionMap_h
+#define LightCollectionMap_h 1
+
+#include "G4ThreeVector.hh"
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+#include <string>
+#include <vector>
+
+/// Light-collection efficiency of every crystal of a bar as a function of
+/// the emission point, on a bins^3 grid in the crystal frame. A bar is a
+/// row of cubes along y joined by grease layers, wrapped by the cover on
+/// the x and z faces and read out at both ends.
+///
+/// Build() is the one-off optical stage: scintillation photons are
+/// emitted isotropically from every voxel and traced through the bar with
+/// Fresnel reflection and refraction (total internal reflection included)
+/// at the crystal faces, bulk attenuation, transmission through the grease
+/// layers, a diffuse reflector behind an air gap on the covered faces, and
+/// detection when they cross into a readout face. The map is written to
+/// disk and read back by later runs with the same key, so production runs
+/// only interpolate it.
+
+namespace CLHEP { class HepRandomEngine; }
+
+class LightCollectionMap
+{
+  public:
+    struct Geometry {
+      G4double crystalSize = 0.;
+      G4double greaseThickness = 0.;
+      G4double coverThickness = 0.;
+      G4int    crystalsPerBar = 0;
+    };
+
+    struct Optics {
+      G4double crystalIndex = 1.65;         // refractive index of the crystal
+      G4double greaseIndex = 1.465;         // grease, also couples the readout
+      G4double coverReflectivity = 0.95;    // diffuse, behind an air gap
+      G4double attenuationLength = 50. * cm;
+    };
+
+    LightCollectionMap() = default;
+   ~LightCollectionMap() = default;
+
+    // every setting that changes the map, as text
+    static std::string MakeKey(const Geometry& geometry, const Optics& optics, G4int bins, G4int photonsPerBin);
+
+    void Build(const Geometry& geometry, const Optics& optics, G4int bins, G4int photonsPerBin);
+    // false if the file is missing or was built with another key
+    G4bool Read(const std::string& fileName, const Geometry& geometry, const Optics& optics,
+                G4int bins, G4int photonsPerBin);
+    G4bool Write(const std::string& fileName) const;
+
+    const std::string& GetKey() const { return fKey; }
+    G4bool IsValid() const { return !fEfficiency.empty(); }
+    G4int GetNumberOfCrystals() const { return fCrystals; }
+    G4double GetMeanEfficiency() const;
+
+    // trilinear in the voxel centres; position in the frame of the crystal
+    G4double Efficiency(G4int crystal, const G4ThreeVector& local) const;
+
+  private:
+    G4bool TracePhoton(G4int crystal, G4ThreeVector position, G4ThreeVector direction,
+                       CLHEP::HepRandomEngine& engine) const;
+    G4double Value(G4int crystal, G4int ix, G4int iy, G4int iz) const;
+
+    std::string fKey;
+    Geometry fGeometry;
+    Optics   fOptics;
+    G4int    fCrystals = 0;
+    G4int    fBins = 0;
+    G4int    fMaxReflections = 10000;
+    std::vector<G4float> fEfficiency;   // [crystal][iz][iy][ix]
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
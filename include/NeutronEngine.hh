@@ -0,0 +1,147 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file NeutronEngine.hh
+/// \brief Definition of the NeutronEngine class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef NeutronEngine_h
+#define NeutronEngine_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+#include <vector>
+
+class DetectorConstruction;
+class PrimaryGeneratorAction;
+class NeutronEngineMessenger;
+class G4Material;
+struct CrystalDeposits;
+
+/// Lightweight neutron transport for design screening. Neutrons are
+/// followed through the axis-aligned crystal boxes of the current
+/// DetectorConstruction (scoring tables); everything between crystals is
+/// treated as vacuum. The boxes are binned in a uniform grid about one
+/// crystal per cell, and each flight walks only the cells along its path,
+/// so the cost per step does not grow with the number of crystals.
+/// Per-element elastic and inelastic cross sections of the crystal material
+/// are tabulated once from the Geant4 hadronic process store, so they come
+/// from the same data as the full simulation.
+///
+/// Physics: elastic scattering is isotropic in the centre-of-mass frame
+/// and the recoil energy is deposited at the collision point, with its
+/// light from the DetectorResponse quenching tabulated per element; inelastic
+/// reactions end the history without a deposit. Primaries are sampled by
+/// the master PrimaryGeneratorAction (/source/ settings). Output uses the
+/// EventSchema trees of the full simulation, in simTree_<time>_engine<N>.root.
+
+class NeutronEngine
+{
+  public:
+    NeutronEngine(DetectorConstruction* detector);
+   ~NeutronEngine();
+
+    void SetPrimaryGenerator(PrimaryGeneratorAction* generator) { fGenerator = generator; }
+    void SetEnergyFloor(G4double energy) { fEnergyFloor = energy; }
+    void SetWriteEvents(G4bool flag) { fWriteEvents = flag; }
+
+    void BeamOn(G4int nEvents);
+    void CompareWithGeant4(G4int nEvents);
+
+    // summary of the last BeamOn
+    G4int GetRunID() const { return fRunID; }
+    G4int GetNumberOfEvents() const { return fNumberOfEvents; }
+    G4int GetNumberOfHitEvents() const { return fNumberOfHitEvents; }
+    G4double GetWeightedHitEvents() const { return fWeightedHitEvents; }
+    G4double GetTotalEdep() const { return fTotalEdep; }
+    G4double GetRunTime() const { return fRunTime; }
+
+  private:
+    struct Box {
+      G4ThreeVector min, max;
+    };
+
+    struct ElementTable {
+      G4double massRatio;                // target mass / neutron mass
+      std::vector<G4double> elastic;     // macroscopic, 1/mm, per energy bin
+      std::vector<G4double> inelastic;
+      std::vector<G4double> lightRatio;  // recoil light / recoil energy, per recoil energy bin
+      G4int recoilSpecies;               // DetectorResponse::Species of the recoil
+    };
+
+    void Prepare();
+    void BuildCrossSectionTables(const G4Material* material);
+    void BuildLightTables(const G4Material* material);
+    G4double Interpolate(const std::vector<G4double>& table, G4double energy) const;
+    static G4bool Intersect(const Box& box, const G4ThreeVector& position, const G4ThreeVector& direction,
+                            G4double& t0, G4double& t1);
+    void BuildGrid();
+    G4int NextBox(const G4ThreeVector& position, const G4ThreeVector& direction,
+                  G4double& tEnter, G4double& tExit) const;
+    void Transport(G4ThreeVector position, G4ThreeVector direction, G4double energy,
+                   G4double weight, CrystalDeposits& deposits) const;
+
+    DetectorConstruction*   fDetector;
+    PrimaryGeneratorAction* fGenerator = nullptr;
+    NeutronEngineMessenger* fMessenger = nullptr;
+
+    // geometry, indexed like the scoring tables
+    std::vector<Box> fBoxes;
+
+    // uniform grid over the boxes; cell c lists the boxes overlapping it in
+    // fCellBoxes[fCellStart[c] .. fCellStart[c + 1]), x fastest
+    G4double fGridMin[3] = {0., 0., 0.};
+    G4double fCellSize[3] = {1., 1., 1.};
+    G4int    fGridCells[3] = {0, 0, 0};
+    std::vector<G4int> fCellStart;
+    std::vector<G4int> fCellBoxes;
+
+    // cross sections on a log energy grid
+    G4int    fNumberOfBins = 500;
+    G4double fMinEnergy;
+    G4double fMaxEnergy;
+    G4double fLogMin = 0., fLogStep = 0.;
+    std::vector<ElementTable> fElements;
+    const G4Material* fTableMaterial = nullptr;
+
+    G4double fEnergyFloor;
+    G4int    fMaxCollisions = 1000;
+    G4bool   fWriteEvents = true;
+
+    // last run
+    G4int    fRunID = -1;
+    G4int    fNumberOfEvents = 0;
+    G4int    fNumberOfHitEvents = 0;
+    G4double fWeightedHitEvents = 0.;
+    G4double fTotalEdep = 0.;
+    G4double fRunTime = 0.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
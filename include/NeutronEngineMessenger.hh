@@ -0,0 +1,32 @@
+#ifndef NeutronEngineMessenger_h
+#define NeutronEngineMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class NeutronEngine;
+class G4UIdirectory;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithABool;
+class G4UIcmdWithADoubleAndUnit;
+
+class NeutronEngineMessenger: public G4UImessenger
+{
+  public:
+    NeutronEngineMessenger(NeutronEngine*);
+    virtual ~NeutronEngineMessenger();
+
+    virtual void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+    NeutronEngine* fEngine;
+
+    G4UIdirectory*             fEngineDir;
+
+    G4UIcmdWithAnInteger*      fBeamOnCmd;
+    G4UIcmdWithAnInteger*      fCompareCmd;
+    G4UIcmdWithADoubleAndUnit* fEnergyFloorCmd;
+    G4UIcmdWithABool*          fWriteEventsCmd;
+};
+
+#endif
@@ -0,0 +1,94 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file ParameterScan.hh
+/// \brief Definition of the ParameterScan class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef ParameterScan_h
+#define ParameterScan_h 1
+
+#include "globals.hh"
+#include <vector>
+
+class ScanMessenger;
+class NeutronEngine;
+
+/// Runs a design study in one warm process. Each point of a grid or of a
+/// Latin-hypercube sample is applied through the existing UI commands
+/// (/detector/... followed by /detector/update, /source/energy), then
+/// /run/beamOn distributes its events over the worker threads. One row per
+/// point is written to a summary table; the per-event output of a point is
+/// the simTree file tagged with the run ID listed in that row.
+
+class ParameterScan
+{
+  public:
+    ParameterScan();
+   ~ParameterScan();
+
+    void AddParameter(const G4String& name, G4double min, G4double max, G4int nPoints, const G4String& unit);
+    void ClearParameters();
+    void SetLatinHypercube(G4bool flag) { fLatinHypercube = flag; }
+    void SetNumberOfSamples(G4int n) { fNumberOfSamples = n; }
+    void SetEventsPerPoint(G4int n) { fEventsPerPoint = n; }
+    void SetSummaryFile(const G4String& name) { fSummaryFile = name; }
+    void SetEngine(NeutronEngine* engine) { fEngine = engine; }
+    void SetUseEngine(G4bool flag) { fUseEngine = flag; }
+
+    void Run();
+
+  private:
+    struct Parameter {
+      G4String name;
+      G4String command;     // UI command taking "<value> <unit>"
+      G4bool   geometry;    // needs /detector/update
+      G4double min, max;    // in units of 'unit'
+      G4int    nPoints;
+      G4String unit;
+    };
+
+    std::vector<std::vector<G4double>> MakeGrid() const;
+    std::vector<std::vector<G4double>> MakeLatinHypercube() const;
+
+    std::vector<Parameter> fParameters;
+    G4bool   fLatinHypercube = false;
+    G4int    fNumberOfSamples = 10;
+    G4int    fEventsPerPoint = 10000;
+    G4String fSummaryFile = "scanSummary.csv";
+
+    // screen with the NeutronEngine instead of full Geant4 runs
+    NeutronEngine* fEngine = nullptr;
+    G4bool fUseEngine = false;
+
+    ScanMessenger* fScanMessenger = nullptr;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -6,10 +6,13 @@
 
 class PrimaryGeneratorAction;
 class G4UIdirectory;
+class G4UIcommand;
 class G4UIcmdWithAString;
 class G4UIcmdWithADoubleAndUnit;
 class G4UIcmdWith3VectorAndUnit;
+class G4UIcmdWith3Vector;
 class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
 
 class ParticleMessenger : public G4UImessenger
 {
@@ -26,6 +29,9 @@ private:
     G4UIdirectory* fSourceDir;
     G4UIdirectory* fDirectionDir;
     G4UIdirectory* fPositionDir;
+    G4UIdirectory* fPhaseSpaceDir;
+    G4UIdirectory* fFissionDir;
+    G4UIdirectory* fSeedingDir;
 
     // Particle commands
     G4UIcmdWithAString* fSetParticleCmd;
@@ -35,10 +41,17 @@ private:
     G4UIcmdWithABool* fSetUniformECmd;
     G4UIcmdWithADoubleAndUnit* fSetMinEnergyCmd;
     G4UIcmdWithADoubleAndUnit* fSetMaxEnergyCmd;
+    G4UIcommand* fSpectrumCmd;
+    G4UIcmdWithAString* fSpectrumFileCmd;
     
     // Position commands
     G4UIcmdWith3VectorAndUnit* fSetSourcePositionCmd;
     G4UIcmdWithABool* fSetRandomPositionCmd;
+    G4UIcmdWithAString* fShapeCmd;
+    G4UIcmdWith3VectorAndUnit* fShapeHalfSizeCmd;
+    G4UIcmdWithADoubleAndUnit* fShapeRadiusCmd;
+    G4UIcmdWithADoubleAndUnit* fShapeHalfLengthCmd;
+    G4UIcmdWith3Vector* fShapeAxisCmd;
 
     // Direction commands
     G4UIcmdWithABool* fSetIsotropicDirectionCmd;
@@ -46,6 +59,28 @@ private:
     G4UIcmdWithADoubleAndUnit* fSetMaxThetaCmd;
     G4UIcmdWithADoubleAndUnit* fSetMinPhiCmd;
     G4UIcmdWithADoubleAndUnit* fSetMaxPhiCmd;
+    G4UIcmdWithABool* fBiasDirectionCmd;
+
+    // Batching commands
+    G4UIcmdWithAnInteger* fBatchSizeCmd;
+    G4UIcmdWithAnInteger* fBenchmarkCmd;
+
+    // Time structure
+    G4UIcmdWithADoubleAndUnit* fActivityCmd;
+
+    // Fission source commands
+    G4UIcmdWithABool* fFissionCmd;
+    G4UIcmdWithABool* fFissionGammasCmd;
+
+    // Reproducibility commands
+    G4UIcmdWithABool* fEventSeedingCmd;
+    G4UIcmdWithAnInteger* fRunSeedCmd;
+
+    // Phase-space replay commands
+    G4UIcmdWithAString* fPhaseSpaceFileCmd;
+    G4UIcmdWithAnInteger* fPhaseSpaceSplitCmd;
+    G4UIcmdWithABool* fPhaseSpaceRotateCmd;
+    G4UIcmdWith3Vector* fPhaseSpaceAxisCmd;
 };
 
 #endif
@@ -0,0 +1,133 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file PhaseSpaceFile.hh
+/// \brief Phase-space file format, writer and memory-mapped reader
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef PhaseSpaceFile_h
+#define PhaseSpaceFile_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/// A phase-space file is a fixed header followed by fixed-size records,
+/// one per particle that crossed the recording envelope inward:
+///   header  "TNPHSP1\0", record count, envelope centre (mm) and radius (mm)
+///   record  position (mm), direction, kinetic energy (MeV), time (ns),
+///           weight, PDG code; single precision, 40 bytes
+/// Records are written in the byte order of the machine that wrote them.
+
+struct PhaseSpaceRecord
+{
+  float   position[3];
+  float   direction[3];
+  float   energy;
+  float   time;
+  float   weight;
+  int32_t pdg;
+};
+
+struct PhaseSpaceHeader
+{
+  char     magic[8];
+  uint64_t numberOfRecords;
+  double   centre[3];
+  double   radius;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+// Buffered sequential writer; the record count in the header is set on Close().
+
+class PhaseSpaceWriter
+{
+  public:
+    PhaseSpaceWriter() = default;
+   ~PhaseSpaceWriter() { Close(); }
+
+    G4bool Open(const G4String& fileName, const G4ThreeVector& centre, G4double radius);
+    void Write(const PhaseSpaceRecord& record);
+    // number of records written, 0 if the file was not open
+    uint64_t Close();
+
+    G4bool IsOpen() const { return fFile != nullptr; }
+
+    // concatenates the records of parts (missing files are skipped) into
+    // output, removing the parts; false if none could be read
+    static G4bool Merge(const std::vector<G4String>& parts, const G4String& output);
+
+  private:
+    void Flush();
+
+    std::FILE* fFile = nullptr;
+    PhaseSpaceHeader fHeader;
+    std::vector<PhaseSpaceRecord> fBuffer;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+// Read-only view of a phase-space file. The file is memory-mapped, so every
+// thread replaying it shares the same pages; the reader asks the kernel to
+// read ahead of the records being accessed.
+
+class PhaseSpaceReader
+{
+  public:
+    PhaseSpaceReader() = default;
+   ~PhaseSpaceReader() { Close(); }
+
+    G4bool Open(const G4String& fileName);
+    void Close();
+
+    G4bool IsOpen() const { return fRecords != nullptr; }
+    const G4String& GetFileName() const { return fFileName; }
+    uint64_t GetNumberOfRecords() const { return fNumberOfRecords; }
+    G4ThreeVector GetCentre() const;
+    G4double GetRadius() const { return fHeader.radius; }
+
+    const PhaseSpaceRecord& Get(uint64_t index);
+
+  private:
+    void Prefetch(uint64_t index);
+
+    G4String fFileName;
+    PhaseSpaceHeader fHeader;
+    const PhaseSpaceRecord* fRecords = nullptr;
+    uint64_t fNumberOfRecords = 0;
+
+    void*       fMapping = nullptr;   // whole file
+    std::size_t fMappingSize = 0;
+    std::vector<PhaseSpaceRecord> fCopy;   // without mmap
+    uint64_t fPrefetched = 0;         // records before this one were requested
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef PhaseSpaceMessenger_h
+#define PhaseSpaceMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class PhaseSpaceRecorder;
+class G4UIdirectory;
+class G4UIcmdWithABool;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+
+class PhaseSpaceMessenger: public G4UImessenger
+{
+  public:
+    PhaseSpaceMessenger(PhaseSpaceRecorder*);
+    virtual ~PhaseSpaceMessenger();
+
+    virtual void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+    PhaseSpaceRecorder* fRecorder;
+
+    G4UIdirectory*             fPhaseSpaceDir;
+    G4UIcmdWithABool*          fRecordCmd;
+    G4UIcmdWithADoubleAndUnit* fMarginCmd;
+    G4UIcmdWithAString*        fFileNameCmd;
+    G4UIcmdWithABool*          fKillCmd;
+};
+
+#endif
@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file PhaseSpaceRecorder.hh
+/// \brief Definition of the PhaseSpaceRecorder class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef PhaseSpaceRecorder_h
+#define PhaseSpaceRecorder_h 1
+
+#include "PhaseSpaceFile.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class DetectorConstruction;
+class PhaseSpaceMessenger;
+class G4Step;
+
+/// Settings of the phase-space recording (/phaseSpace/). The envelope is
+/// the bounding sphere of the detector grown by a margin; every particle
+/// that crosses it inward is written to a phase-space file and, by
+/// default, killed, so the recording run only pays for the environment.
+/// Each thread writes its own file; the master merges them at the end of
+/// the run into <fileName>_run<N>.phsp, which /source/phaseSpace/file
+/// replays.
+///
+/// Particles created inside the envelope are not recorded: keep the
+/// margin inside the low-density region around the detector.
+///
+/// Owned by the DetectorConstruction and shared read-only by all threads;
+/// change it between runs only.
+
+class PhaseSpaceRecorder
+{
+  public:
+    PhaseSpaceRecorder(const DetectorConstruction* detector);
+   ~PhaseSpaceRecorder();
+
+    void SetRecording(G4bool flag) { fRecording = flag; }
+    void SetMargin(G4double margin) { fMargin = margin; }
+    void SetFileName(const G4String& name) { fFileName = name; }
+    void SetKillAtEnvelope(G4bool flag) { fKillAtEnvelope = flag; }
+
+    G4bool IsRecording() const { return fRecording; }
+    G4bool GetKillAtEnvelope() const { return fKillAtEnvelope; }
+    G4ThreeVector GetCentre() const;
+    G4double GetRadius() const;
+
+    // the file of one run, or of one of its worker threads
+    G4String GetFileName(G4int runID, G4int threadID = -1) const;
+    // on the master after the workers closed their files
+    void MergeThreadFiles(G4int runID, G4int numberOfThreads) const;
+
+    // true if the straight step crosses the envelope from outside to
+    // inside; record then holds the particle at the crossing point
+    G4bool Crossing(const G4Step* step, PhaseSpaceRecord& record) const;
+
+  private:
+    const DetectorConstruction* fDetector;
+    G4bool   fRecording = false;
+    G4bool   fKillAtEnvelope = true;
+    G4double fMargin;
+    G4String fFileName = "phaseSpace";
+
+    PhaseSpaceMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -33,6 +33,13 @@
 
 #include "G4VModularPhysicsList.hh"
 #include "globals.hh"
+#include "G4Timer.hh"
+#include <chrono>
+#include <map>
+#include <vector>
+
+class PhysicsMessenger;
+class G4ProductionCuts;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -43,9 +50,39 @@ public:
  ~PhysicsList() override;
 
 public:
+  void ConstructParticle() override;
   void ConstructProcess() override;
   void SetCuts()override;
 
+  // Constructors by name (see ListConstructors); PreInit only
+  void SetConstructorEnabled(const G4String& name, G4bool flag);
+  void ListConstructors() const;
+  void PrintStartupReport() const;
+
+  // EM constructor: opt0, opt3, opt4 or livermore; PreInit only
+  void SetEmOption(const G4String& option) { fEmOption = option; }
+  const G4String& GetEmOption() const { return fEmOption; }
+
+  // e- and gamma secondaries below this energy are deposited where they
+  // are created instead of being tracked (see StackingAction); 0 = off
+  void SetLocalDepositThreshold(G4double energy) { fLocalDepositThreshold = energy; }
+  G4double GetLocalDepositThreshold() const { return fLocalDepositThreshold; }
+
+  // Kill policies, applied by SteppingAction and StackingAction:
+  // tracks leaving a sphere of the detector's bounding radius plus the
+  // margin (negative = off), tracks later than the time cut (0 = off) and
+  // neutrons below the energy floor (0 = off)
+  void SetKillEnvelopeMargin(G4double margin) { fKillEnvelopeMargin = margin; }
+  G4double GetKillEnvelopeMargin() const { return fKillEnvelopeMargin; }
+  void SetKillTime(G4double time) { fKillTime = time; }
+  G4double GetKillTime() const { return fKillTime; }
+  void SetNeutronEnergyFloor(G4double energy) { fNeutronEnergyFloor = energy; }
+  G4double GetNeutronEnergyFloor() const { return fNeutronEnergyFloor; }
+
+  // Production cuts per region; "World" sets the default cut
+  void SetRegionCut(const G4String& region, G4double cut);
+  void PrintRegionCuts() const;
+
 private:
    G4VPhysicsConstructor* fHadronElastic;
    G4VPhysicsConstructor* fHadronInelastic;
@@ -55,6 +92,31 @@ private:
    G4VPhysicsConstructor* fElectromagnetic;
    G4VPhysicsConstructor* fDecay;
    G4VPhysicsConstructor* fRadioactiveDecay;
+   G4VPhysicsConstructor* fStopping;
+   G4VPhysicsConstructor* fFastSimulation;
+   G4VPhysicsConstructor* fBiasing;
+
+   G4VPhysicsConstructor* CreateConstructor(const G4String& name);
+   G4VPhysicsConstructor* CreateEmConstructor();
+
+   std::map<G4String, G4bool> fEnabled;
+   std::vector<G4VPhysicsConstructor*> fActiveConstructors;
+   G4String fEmOption = "opt0";
+   G4double fLocalDepositThreshold = 0.;
+   G4double fKillEnvelopeMargin = -1.;
+   G4double fKillTime = 0.;
+   G4double fNeutronEnergyFloor = 0.;
+
+   // startup report
+   G4Timer fConstructTimer;
+   G4double fMemoryAtStart = 0.;
+   std::chrono::steady_clock::time_point fCreated;
+
+   void ApplyRegionCuts();
+   static G4ProductionCuts* DefaultProductionCuts();
+
+   std::map<G4String, G4double> fRegionCuts;
+   PhysicsMessenger* fMessenger;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,43 @@
+#ifndef PhysicsMessenger_h
+#define PhysicsMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class PhysicsList;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+
+class PhysicsMessenger: public G4UImessenger
+{
+  public:
+    PhysicsMessenger(PhysicsList*);
+    virtual ~PhysicsMessenger();
+
+    virtual void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+    PhysicsList* fPhysicsList;
+
+    G4UIdirectory*           fPhysDir;
+
+    G4UIcommand*             fRegionCutCmd;
+    G4UIcmdWithoutParameter* fPrintCutsCmd;
+
+    G4UIcmdWithAString*      fEnableCmd;
+    G4UIcmdWithAString*      fDisableCmd;
+    G4UIcmdWithoutParameter* fListCmd;
+
+    G4UIcmdWithAString*        fEmOptionCmd;
+    G4UIcmdWithADoubleAndUnit* fLocalDepositCmd;
+
+    G4UIdirectory*             fKillDir;
+    G4UIcmdWithADoubleAndUnit* fKillEnvelopeCmd;
+    G4UIcmdWithADoubleAndUnit* fKillTimeCmd;
+    G4UIcmdWithADoubleAndUnit* fNeutronFloorCmd;
+};
+
+#endif
@@ -38,7 +38,12 @@
 
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleGun.hh"
+#include "EnergySpectrum.hh"
+#include "FissionSource.hh"
+#include "PhaseSpaceFile.hh"
+#include "SourceShape.hh"
 #include "globals.hh"
+#include <vector>
 
 class G4Event;
 class DetectorConstruction;
@@ -55,6 +60,20 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
   public:
     virtual void GeneratePrimaries(G4Event*);
     G4ParticleGun* GetParticleGun() {return fParticleGun;};
+    const G4ParticleDefinition* GetParticleDefinition() const {return fParticleDef;};
+
+    // one primary from the /source/ settings; also used by the NeutronEngine.
+    // weight is 1 unless the direction is biased toward the detector.
+    void SamplePrimary(G4ThreeVector& position, G4ThreeVector& direction, G4double& energy, G4double& weight);
+
+    // same distribution, popped from a block of primaries pre-generated
+    // with bulk random draws; SamplePrimary() when the batch size is 1
+    void NextPrimary(G4ThreeVector& position, G4ThreeVector& direction, G4double& energy, G4double& weight);
+    // drop what is left of the block, e.g. after the settings changed
+    void ResetBatch() { fBatch.next = fBatch.size = 0; }
+
+    // time nPrimaries calls of SamplePrimary() and of NextPrimary()
+    void BenchmarkGenerator(G4int nPrimaries);
 
   private:
 
@@ -67,20 +86,81 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 
     void PrintSettings();
 
+    // pre-generated primaries, one array per component; the generator is
+    // per thread, so the block is thread-local
+    struct PrimaryBatch {
+      std::vector<G4double> x, y, z;
+      std::vector<G4double> dx, dy, dz;
+      std::vector<G4double> energy, weight;
+      std::size_t next = 0;
+      std::size_t size = 0;
+    };
+    void FillBatch();
+    G4ThreeVector SamplePosition() const;
+    G4ThreeVector SampleDirection() const;
+
+    // replay: the record for this event ID, each record used fReplaySplitting times
+    G4bool ReplayPrimary(G4int eventID, G4ThreeVector& position, G4ThreeVector& direction, G4double& energy,
+                         G4double& weight, G4double& time, G4ParticleDefinition*& particle);
+
+    PhaseSpaceReader fReplay;
+    G4int fReplaySplitting = 1;
+    G4bool fReplayRotation = false;
+    G4ThreeVector fReplayAxis = G4ThreeVector(0., 0., 1.);
+    G4bool fReplayRecycled = false;
+
+    PrimaryBatch fBatch;
+    std::vector<G4double> fUniform;   // bulk random numbers
+    G4int fBatchSize = 1;   // off by default: a block ties each primary to its place in the block
+    G4int fBatchRunID = -1;
+
+    // time-structured source: Poisson emission times at fActivity, one
+    // time line per thread starting at 0 each run; 0 = all primaries at t = 0
+    G4double fActivity = 0.;
+    G4double fEmissionTime = 0.;
+    G4double NextEmissionTime();
+
+    // per-event seeds: the engine is reseeded at the start of every event
+    // from (fRunSeed, run ID, event ID), so an event draws the same numbers
+    // whichever thread runs it and whatever ran before it on that thread
+    G4bool fEventSeeding = false;
+    G4long fRunSeed = 1234567;
+
+    // Cf-252 fission mode: all prompt neutrons and gammas of one fission
+    // in one vertex at the source position, analog (no direction biasing)
+    void GenerateFission(G4Event* event, G4double time);
+    G4bool fUseFission = false;
+    G4bool fFissionGammas = true;
+    FissionSource fFission;
+    FissionSource::Fission fFissionEvent;
+    G4ParticleDefinition* fNeutronDef = nullptr;
+    G4ParticleDefinition* fGammaDef = nullptr;
+
+    // direction biasing: sample inside the cone subtended by the detector's
+    // bounding sphere, weight = analog density / cone density
+    G4bool SampleBiasedDirection(const G4ThreeVector& position, G4ThreeVector& direction, G4double& weight) const;
+    G4double DirectionDensity(const G4ThreeVector& direction) const;
+
     // Particle properties
     G4double fEnergy       ;// = 1.0 * MeV; 
     G4bool fUniformE       ;// = false;
     G4double fMinEnergy    ;// = 0.0;     
     G4double fMaxEnergy    ;// = 10.0 * MeV; 
+    G4bool fUseSpectrum = false;
+    EnergySpectrum fSpectrum;
+    G4double fSpectrumMaxEnergy;// = 20.0 * MeV, end of the analytic tables
+    G4int fSpectrumPoints = 4001;
     
     G4ThreeVector fPosition;// = G4ThreeVector(0., 0., 0.);
     G4bool fRandomPosition  ;//= false; 
+    SourceShape fShape;       // extended source around fPosition
     
     G4bool fIsotropic       ;//= false;      
     G4double fMinTheta ;//= -180.0 * deg;    
     G4double fMaxTheta ;//= 180.0 * deg; 
     G4double fMinPhi   ;//= 0.0;         
     G4double fMaxPhi   ;//= 360.0 * deg; 
+    G4bool fBiasDirection = false;
 
 
 
@@ -91,15 +171,54 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     void SetUniformEnergy(G4bool flag) { fUniformE = flag; }
     void SetMinEnergy(G4double energy) { fMinEnergy = energy; }
     void SetMaxEnergy(G4double energy) { fMaxEnergy = energy; }
+
+    // sampled spectra take precedence over /source/energy and the uniform
+    // range until SetMonoenergetic(); a table that fails to build keeps the
+    // previous setting
+    void SetWattSpectrum(G4double a, G4double b);
+    void SetMaxwellianSpectrum(G4double temperature);
+    void SetAmBeSpectrum();
+    void SetSpectrumFile(const G4String& fileName);
+    void SetMonoenergetic() { fUseSpectrum = false; }
     
     void SetSourcePosition(const G4ThreeVector& pos) { fPosition = pos; }
     void SetRandomPosition(G4bool flag) { fRandomPosition = flag; }
+    // extended source centred on the source position; random position
+    // takes precedence
+    void SetSourceShape(const G4String& name) { fShape.SetType(name); }
+    void SetSourceHalfSize(const G4ThreeVector& halfSize) { fShape.SetHalfSize(halfSize); }
+    void SetSourceRadius(G4double radius) { fShape.SetRadius(radius); }
+    void SetSourceHalfLength(G4double halfLength) { fShape.SetHalfLength(halfLength); }
+    void SetSourceAxis(const G4ThreeVector& axis) { fShape.SetAxis(axis); }
     
     void SetIsotropic(G4bool flag) { fIsotropic = flag; }
     void SetMinTheta(G4double theta) { fMinTheta = theta; }
     void SetMaxTheta(G4double theta) { fMaxTheta = theta; }
     void SetMinPhi(G4double phi) { fMinPhi = phi; }
     void SetMaxPhi(G4double phi) { fMaxPhi = phi; }
+    void SetBiasDirection(G4bool flag) { fBiasDirection = flag; }
+
+    void SetBatchSize(G4int size) { fBatchSize = size; ResetBatch(); }
+
+    // replay a phase-space file instead of the settings above; "none" stops
+    void SetPhaseSpaceFile(const G4String& fileName);
+    void SetPhaseSpaceSplitting(G4int n) { fReplaySplitting = n; }
+    void SetPhaseSpaceRotation(G4bool flag) { fReplayRotation = flag; }
+    void SetPhaseSpaceAxis(const G4ThreeVector& axis) { fReplayAxis = axis.unit(); }
+
+    void SetActivity(G4double activity) { fActivity = activity; }
+    G4double GetActivity() const { return fActivity; }
+
+    // takes precedence over the particle and energy settings; replay over it
+    void SetFission(G4bool flag);
+    void SetFissionGammas(G4bool flag) { fFissionGammas = flag; }
+
+    // results independent of the thread count; turns batching off, since a
+    // block of primaries would span events of different seeds
+    void SetEventSeeding(G4bool flag) { fEventSeeding = flag; ResetBatch(); }
+    void SetRunSeed(G4long seed) { fRunSeed = seed; }
+    G4bool IsEventSeeding() const { return fEventSeeding; }
+    void SeedEvent(G4int runID, G4int eventID) const;
 
 
 
@@ -0,0 +1,69 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file RecoilFastSimModel.hh
+/// \brief Definition of the RecoilFastSimModel class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef RecoilFastSimModel_h
+#define RecoilFastSimModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "G4EmCalculator.hh"
+#include "globals.hh"
+
+class DetectorConstruction;
+class G4Region;
+
+/// Deposits recoil protons and ions in one step when they certainly stop
+/// inside the current crystal: the triggered condition is
+///   range(E) < safetyFraction * distance to the nearest crystal surface,
+/// with the range from the EM tables of the crystal material. Since the
+/// isotropic safety bounds the distance to every surface, the whole
+/// deposit stays in this crystal. Recoils near a boundary are tracked
+/// normally, so per-crystal deposits are unchanged up to delta rays and
+/// nuclear interactions of the recoil itself.
+
+class RecoilFastSimModel : public G4VFastSimulationModel
+{
+  public:
+    RecoilFastSimModel(const G4String& name, G4Region* region, const DetectorConstruction* detector);
+    virtual ~RecoilFastSimModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+    virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+  private:
+    const DetectorConstruction* fDetector;
+    G4EmCalculator fCalculator;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -40,9 +40,14 @@
 #include "globals.hh"
 #include "G4ThreeVector.hh"
 #include "G4LogicalVolume.hh"
+#include "G4Timer.hh"
 #include "TFile.h"
 #include "TTree.h"
-#include "TVector3.h"
+#include "TH1D.h"
+#include "EventSchema.hh"
+#include "PhaseSpaceFile.hh"
+#include "EventBuilder.hh"
+#include "DetectorResponse.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -63,7 +68,22 @@ class RunAction : public G4UserRunAction
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
 
-    void FillPerEvent(const std::map<G4String, G4double>& edepMap);
+    void FillPerEvent(const CrystalDeposits& deposits, G4double sourceWeight);
+    void AddTrackingCounts(G4long steps, G4long localDeposits);
+    void AddKilledTracks(G4long envelope, G4long time, G4long energy);
+    void WritePhaseSpace(const PhaseSpaceRecord& record) { fPhaseSpaceWriter.Write(record); }
+    // time-structured readout; no-op unless /response/builder/enable
+    void BuildEvents(const CrystalDeposits& deposits, G4int eventID, G4double emissionTime);
+    G4bool IsBuildingEvents() const { return fBuiltTree != nullptr; }
+
+    // run summary, merged over threads; valid on the master after EndOfRunAction
+    G4int GetRunID() const { return fRunID; }
+    G4int GetNumberOfEvents() const { return fNumberOfEvents; }
+    G4int GetNumberOfHitEvents() const { return fNumberOfHitEvents.GetValue(); }
+    const std::vector<G4double>& GetCrystalWeightedHits() const { return fCrystalWeightedHits; }
+    G4double GetTotalEdep() const { return fTotalEdep.GetValue(); }
+    G4double GetRunTime() const { return fRunTime; }
+    G4long GetNumberOfSteps() const { return fNumberOfSteps.GetValue(); }
 
     void Clear(); 
     
@@ -73,32 +93,70 @@ class RunAction : public G4UserRunAction
   void FillInitialConditions(const G4ThreeVector& Direction,
                                     const G4ThreeVector& Position,
                                     const G4double& Energy,
-                                    const std::string name); 
+                                    const G4int pdg,
+                                    const G4double weight,
+                                    const G4int fissionNeutrons = 0,
+                                    const G4int fissionGammas = 0); 
     //bool visual=false;
   private:
     DetectorConstruction* fDetector;
     TTree* fTree;
     TTree* fDetectorTree;
     TTree* fPrimaryTree;
+    TTree* fBuiltTree = nullptr;
     TFile* fRootFile;
     //std::vector<G4double> vec_Edep;
     //std::vector<G4String> vec_VolumeName;
     
     std::map<G4String, G4double> fEdepMap;
 
-    std::vector<std::string> fVolumeNames;  // Store logical volume names
-    std::vector<double> fEdepValues;   // Store energy depositions
     private:
     PrimaryGeneratorAction*    fPrimary;
 
-    // get detetor conditions at end of run action from detector construction
-    std::vector<std::string> ScoringName, ScoringMaterial;
-    std::vector<TVector3> ScoringLocation, ScoringSize;
-
-    // get initial beam conditions from primaryAction generator at the start of each event
-    TVector3 BeamDirection, SourcePosition;
-    double  BeamEnergy;
-    std::string beamName;
+    // output buffers, layout defined once in EventSchema.hh
+    EventSchema::EventRecord    fEventRecord;     // per event energy deposition
+    EventSchema::PrimaryRecord  fPrimaryRecord;   // per event beam conditions
+    EventSchema::GeometryRecord fGeometryRecord;  // per scoring volume, end of run
+    EventSchema::BuiltEventRecord fBuiltRecord;   // per built event of the readout
+
+    // weighted energy spectrum per scoring volume, written next to the trees
+    std::vector<TH1D*> fEdepHists;
+    std::vector<TH1D*> fLightHists;
+
+    // particles entering the recording envelope, one file per thread
+    PhaseSpaceWriter fPhaseSpaceWriter;
+
+    // pulses of this thread's time line, merged into readout events
+    EventBuilder fBuilder;
+    std::vector<CrystalDeposits::TimedDeposit> fTimedDeposits;   // sorted copy
+
+    // per-crystal deposit sums in integer units of kChecksumQuantum: unlike
+    // floating-point sums they do not depend on the order the threads'
+    // events are added in, so equal events give a bitwise-equal checksum
+    std::vector<G4long> fCrystalChecksum;
+    // per-crystal sum of CrystalWeight over the events that hit the crystal;
+    // unlike one weight per event it stays unbiased under track biasing
+    std::vector<G4double> fCrystalWeightedHits;
+    void MergeCrystalSums();
+
+    // run summary
+    G4Accumulable<G4int>    fNumberOfHitEvents = 0;   // events with any crystal deposit
+    G4Accumulable<G4double> fTotalEdep = 0.;          // summed over crystals and events
+    G4Accumulable<G4long>   fNumberOfSteps = 0;       // all tracks, all volumes
+    G4Accumulable<G4long>   fNumberOfLocalDeposits = 0;  // secondaries deposited untracked
+    G4Accumulable<G4long>   fKilledEnvelope = 0;      // tracks killed by each kill policy
+    G4Accumulable<G4long>   fKilledTime = 0;
+    G4Accumulable<G4long>   fKilledEnergy = 0;
+    G4Accumulable<G4long>   fPhaseSpaceRecords = 0;  // written to the phase-space file
+    G4Accumulable<G4long>   fBuiltEvents = 0;        // event builder output
+    G4Accumulable<G4long>   fBuilderPulses = 0;
+    G4Accumulable<G4long>   fPiledUpPulses = 0;
+    G4Accumulable<G4long>   fDeadTimeLosses = 0;
+    G4Accumulable<G4long>   fRandomCoincidences = 0;
+    G4int    fRunID = -1;
+    G4int    fNumberOfEvents = 0;
+    G4Timer  fTimer;
+    G4double fRunTime = 0.;
 
 
 
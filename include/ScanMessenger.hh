@@ -0,0 +1,38 @@
+#ifndef ScanMessenger_h
+#define ScanMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class ParameterScan;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithAString;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithABool;
+
+class ScanMessenger: public G4UImessenger
+{
+  public:
+    ScanMessenger(ParameterScan*);
+    virtual ~ScanMessenger();
+    
+    virtual void SetNewValue(G4UIcommand*, G4String);
+    
+  private:
+    ParameterScan* fScan;
+    
+    G4UIdirectory*           fScanDir;
+
+    G4UIcommand*             fAddParameterCmd;
+    G4UIcmdWithoutParameter* fClearCmd;
+    G4UIcmdWithAString*      fModeCmd;
+    G4UIcmdWithAnInteger*    fSamplesCmd;
+    G4UIcmdWithAnInteger*    fEventsPerPointCmd;
+    G4UIcmdWithAString*      fSummaryFileCmd;
+    G4UIcmdWithABool*        fUseEngineCmd;
+    G4UIcmdWithoutParameter* fRunCmd;
+};
+
+#endif
@@ -0,0 +1,86 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file SourceShape.hh
+/// \brief Definition of the SourceShape class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef SourceShape_h
+#define SourceShape_h 1
+
+#include "G4SystemOfUnits.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+/// Emission region of an extended source, centred on the source position
+/// with its local z axis along a given direction:
+///   point           the centre
+///   box             half sizes along local x, y, z
+///   disk            radius, in the local xy plane
+///   cylinder        radius and half length along local z (volume)
+///   sphereSurface   radius
+///   sphereVolume    radius
+/// Every shape is sampled directly from three uniform numbers by inverting
+/// its cumulative distributions (r = R sqrt(u) on a disk, R cbrt(u) in a
+/// ball, ...): no rejection loop, no navigator query, and a fixed number of
+/// random draws per primary, so the numbers can come in bulk.
+
+class SourceShape
+{
+  public:
+    enum Type { kPoint, kBox, kDisk, kCylinder, kSphereSurface, kSphereVolume };
+
+    SourceShape() = default;
+   ~SourceShape() = default;
+
+    // "point", "box", "disk", "cylinder", "sphereSurface", "sphereVolume";
+    // false, keeping the previous type, for any other name
+    G4bool SetType(const G4String& name);
+    void SetHalfSize(const G4ThreeVector& halfSize) { fHalfSize = halfSize; }
+    void SetRadius(G4double radius) { fRadius = radius; }
+    void SetHalfLength(G4double halfLength) { fHalfLength = halfLength; }
+    void SetAxis(const G4ThreeVector& axis) { fAxis = axis.unit(); }
+
+    Type GetType() const { return fType; }
+    G4bool IsPoint() const { return fType == kPoint; }
+    G4String Describe() const;
+
+    // position around centre from three uniform numbers in [0, 1)
+    G4ThreeVector Sample(const G4ThreeVector& centre, G4double u, G4double v, G4double w) const;
+
+  private:
+    Type fType = kPoint;
+    G4ThreeVector fHalfSize = G4ThreeVector(1. * cm, 1. * cm, 1. * cm);
+    G4double fRadius = 1. * cm;
+    G4double fHalfLength = 1. * cm;
+    G4ThreeVector fAxis = G4ThreeVector(0., 0., 1.);
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -35,17 +35,22 @@
 
 #include "G4UserSteppingAction.hh"
 #include "globals.hh"
+#include <vector>
 
 class EventAction;
 class G4LogicalVolume;
 class DetectorConstruction;
+class PhysicsList;
+class G4Track;
+class G4Step;
+class G4ParticleDefinition;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 class SteppingAction : public G4UserSteppingAction
 {
   public:
-    SteppingAction(EventAction*,DetectorConstruction* det);
+    SteppingAction(EventAction*,DetectorConstruction* det, const PhysicsList* physics = nullptr);
    ~SteppingAction();
 
     virtual void UserSteppingAction(const G4Step*);
@@ -54,6 +59,19 @@ class SteppingAction : public G4UserSteppingAction
     EventAction*  fEventAction;  
     std::vector<G4LogicalVolume*> fScoringVolumes;  
     DetectorConstruction* fDetector;  
+    const PhysicsList* fPhysicsList;
+
+    // DetectorResponse::Species of a particle, from a table filled once per definition
+    G4int Species(const G4ParticleDefinition* particle);
+    std::vector<G4int> fSpeciesTable;
+
+    // quenched light of the step deposit, MeVee
+    G4double Light(const G4Step* step, G4int species, G4double edep) const;
+    // mean photoelectrons of that light, from the light collection map
+    G4double PhotoElectrons(const G4Step* step, G4int index, G4double light) const;
+
+    // kill policies of the physics list, on the post-step state
+    void ApplyKillPolicies(G4Track* track);
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
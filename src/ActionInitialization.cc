@@ -33,13 +33,19 @@
 #include "EventAction.hh"
 //#include "TrackingAction.hh"
 #include "SteppingAction.hh"
+#include "StackingAction.hh"
 #include "DetectorConstruction.hh"
+#include "NeutronEngine.hh"
+#include "G4Threading.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-ActionInitialization::ActionInitialization(DetectorConstruction* detector)
+ActionInitialization::ActionInitialization(DetectorConstruction* detector, const PhysicsList* physics,
+                                           NeutronEngine* engine)
  : G4VUserActionInitialization(),
-   fDetector(detector)
+   fDetector(detector),
+   fPhysicsList(physics),
+   fEngine(engine)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -56,6 +62,8 @@ void ActionInitialization::BuildForMaster() const
   RunAction* runAction = new RunAction(fDetector );
   PrimaryGeneratorAction* primary = new PrimaryGeneratorAction(fDetector,runAction);
 
+  // the master generator follows the /source/ commands; the engine samples from it
+  if (fEngine) fEngine->SetPrimaryGenerator(primary);
 
   SetUserAction(runAction);
 }
@@ -69,10 +77,14 @@ void ActionInitialization::Build() const
 
   PrimaryGeneratorAction* primary = new PrimaryGeneratorAction(fDetector,runAction);
   SetUserAction(primary);
+
+  // sequential mode: Build() runs on the master thread
+  if (fEngine && G4Threading::IsMasterThread()) fEngine->SetPrimaryGenerator(primary);
   
 
   EventAction* eventAction = new EventAction(runAction,fDetector);
   SetUserAction(eventAction);  
 
-  SetUserAction(new SteppingAction(eventAction,fDetector));
+  SetUserAction(new SteppingAction(eventAction,fDetector,fPhysicsList));
+  SetUserAction(new StackingAction(eventAction,fDetector,fPhysicsList));
 }  
@@ -0,0 +1,104 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file CrystalBiasingOperator.cc
+/// \brief Implementation of the CrystalBiasingOperator class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "CrystalBiasingOperator.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4BiasingProcessInterface.hh"
+#include "G4BiasingProcessSharedData.hh"
+#include "G4BOptnChangeCrossSection.hh"
+#include "G4Neutron.hh"
+#include "G4ProcessManager.hh"
+#include "G4Track.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CrystalBiasingOperator::CrystalBiasingOperator(const DetectorConstruction* detector)
+ : G4VBiasingOperator("CrystalBiasingOperator"),
+   fDetector(detector),
+   fNeutron(G4Neutron::Definition())
+{}
+
+CrystalBiasingOperator::~CrystalBiasingOperator()
+{
+  for (auto& entry : fOperations) delete entry.second;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CrystalBiasingOperator::StartRun()
+{
+  // one cross-section operation per wrapped neutron process, created once
+  if (!fOperations.empty()) return;
+
+  const G4BiasingProcessSharedData* sharedData =
+    G4BiasingProcessInterface::GetSharedData(fNeutron->GetProcessManager());
+  if (!sharedData) return;
+
+  for (const auto* wrapper : sharedData->GetPhysicsBiasingProcessInterfaces()) {
+    G4String name = "XSchange-" + wrapper->GetWrappedProcess()->GetProcessName();
+    fOperations[wrapper] = new G4BOptnChangeCrossSection(name);
+  }
+}
+
+
+G4VBiasingOperation* CrystalBiasingOperator::ProposeOccurenceBiasingOperation(const G4Track* track,
+                                                                              const G4BiasingProcessInterface* callingProcess)
+{
+  if (track->GetDefinition() != fNeutron) return nullptr;
+
+  G4double scale = fDetector->GetBiasScale();
+  if (scale == 1.) return nullptr;
+
+  G4double analogLength = callingProcess->GetWrappedProcess()->GetCurrentInteractionLength();
+  if (analogLength > DBL_MAX / 10.) return nullptr;
+  G4double biasedXS = scale / analogLength;
+
+  auto entry = fOperations.find(callingProcess);
+  if (entry == fOperations.end()) return nullptr;
+  G4BOptnChangeCrossSection* operation = entry->second;
+
+  // same bookkeeping as the Geant4 GB01 example: resample after an
+  // interaction, otherwise carry the remaining interaction length over
+  const G4VBiasingOperation* previous = callingProcess->GetPreviousOccurenceBiasingOperation();
+  if (previous != operation || operation->GetInteractionOccured()) {
+    operation->SetBiasedCrossSection(biasedXS);
+    operation->Sample();
+  } else {
+    operation->UpdateForStep(callingProcess->GetPreviousStepSize());
+    operation->SetBiasedCrossSection(biasedXS);
+    operation->UpdateForStep(0.0);
+  }
+  return operation;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
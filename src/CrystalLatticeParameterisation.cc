@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file CrystalLatticeParameterisation.cc
+/// \brief Implementation of the CrystalLatticeParameterisation class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "CrystalLatticeParameterisation.hh"
+
+#include "G4VPhysicalVolume.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CrystalLatticeParameterisation::CrystalLatticeParameterisation(G4int nx, G4int ny, G4int nz, G4double pitch)
+ : G4VPVParameterisation(),
+   fNx(nx), fNy(ny), fNz(nz), fPitch(pitch)
+{}
+
+CrystalLatticeParameterisation::~CrystalLatticeParameterisation()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CrystalLatticeParameterisation::GetIndices(G4int copyNo, G4int& ix, G4int& iy, G4int& iz) const
+{
+  ix = copyNo % fNx;
+  iy = (copyNo / fNx) % fNy;
+  iz = copyNo / (fNx * fNy);
+}
+
+G4ThreeVector CrystalLatticeParameterisation::GetPosition(G4int copyNo) const
+{
+  G4int ix, iy, iz;
+  GetIndices(copyNo, ix, iy, iz);
+  return G4ThreeVector((ix - 0.5 * (fNx - 1)) * fPitch,
+                       (iy - 0.5 * (fNy - 1)) * fPitch,
+                       (iz - 0.5 * (fNz - 1)) * fPitch);
+}
+
+void CrystalLatticeParameterisation::ComputeTransformation(const G4int copyNo, G4VPhysicalVolume* physVol) const
+{
+  physVol->SetTranslation(GetPosition(copyNo));
+  physVol->SetRotation(nullptr);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -34,10 +34,48 @@
 #include "G4PhysicalVolumeStore.hh"
 #include "G4LogicalVolumeStore.hh"
 #include "G4SolidStore.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
 #include "G4RunManager.hh"
 #include "DetectorMessenger.hh"
+#include "ProcessMemory.hh"
+#include "DetectorResponse.hh"
+#include "PhaseSpaceRecorder.hh"
 #include "G4VisAttributes.hh"
 #include "G4SubtractionSolid.hh"
+#include "G4PVParameterised.hh"
+#include "G4Navigator.hh"
+#include "G4VTouchable.hh"
+#include "G4RandomDirection.hh"
+#include "G4Timer.hh"
+#include "Randomize.hh"
+#include "CrystalLatticeParameterisation.hh"
+#include "RecoilFastSimModel.hh"
+#include "CrystalBiasingOperator.hh"
+#include "G4BOptrForceCollision.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cstdint>
+#include <filesystem>
+#include <algorithm>
+
+#ifdef TEXNEUTSIM_USE_GDML
+#include "G4GDMLParser.hh"
+#endif
+
+namespace {
+  // FNV-1a: stable across compilers and runs, unlike std::hash
+  std::uint64_t HashString(const std::string& text) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+}
 
 ///////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////
@@ -57,6 +95,8 @@ DetectorConstruction::DetectorConstruction(){
 
   // READ-IN //
   fDetectorMessenger = new DetectorMessenger(this);
+  fResponse = new DetectorResponse(this);
+  fPhaseSpaceRecorder = new PhaseSpaceRecorder(this);
 
   fBarLength = fCrystalsPerBar * fCrystalSize + (fCrystalsPerBar - 1) * fGreaseThickness;
 }
@@ -67,6 +107,9 @@ DetectorConstruction::DetectorConstruction(){
 
 DetectorConstruction::~DetectorConstruction(){
     delete fDetectorMessenger;
+    delete fResponse;
+    delete fPhaseSpaceRecorder;
+    delete fLatticeParam;
 }
 
 ///////////////////////////////////////////////////////////////
@@ -143,6 +186,48 @@ void DetectorConstruction::SetWorldSize(G4double size){
 
 }
 
+void DetectorConstruction::SetCheckOverlaps(G4bool flag){
+  fCheckOverlaps = flag;
+}
+
+void DetectorConstruction::SetGeometryCacheDir(const G4String& dir){
+  fGeometryCacheDir = dir;
+}
+
+void DetectorConstruction::SetNestedBars(G4bool flag){
+  fNestedBars = flag;
+}
+
+void DetectorConstruction::SetSmartless(G4double smartless){
+  fSmartless = smartless;
+}
+
+void DetectorConstruction::SetUseLattice(G4bool flag){
+  fUseLattice = flag;
+}
+
+void DetectorConstruction::SetRecoilFastSim(G4bool flag){
+  fRecoilFastSim = flag;
+}
+
+void DetectorConstruction::SetRecoilSafetyFraction(G4double fraction){
+  fRecoilSafetyFraction = fraction;
+}
+
+void DetectorConstruction::SetBiasMode(const G4String& mode){
+  fBiasMode = mode;
+}
+
+void DetectorConstruction::SetBiasScale(G4double scale){
+  fBiasScale = scale;
+}
+
+void DetectorConstruction::SetLatticeSize(G4int nx, G4int ny, G4int nz){
+  fLatticeNx = nx;
+  fLatticeNy = ny;
+  fLatticeNz = nz;
+}
+
 
 void DetectorConstruction::SetWorldMaterial(G4String materialChoice){
 
@@ -230,22 +315,80 @@ G4VPhysicalVolume* DetectorConstruction::Construct(){
 }
 
 
+void DetectorConstruction::ConstructSDandField(){
+
+  // fast simulation models are thread local; the crystal region outlives
+  // geometry rebuilds, so one model per thread stays attached to it
+  static G4ThreadLocal RecoilFastSimModel* recoilModel = nullptr;
+  if (fRecoilFastSim && !recoilModel) {
+    G4Region* region = G4RegionStore::GetInstance()->FindOrCreateRegion(kCrystalRegion);
+    recoilModel = new RecoilFastSimModel("RecoilFastSim", region, this);
+  }
+
+  // biasing operators are thread local too and attach to the crystal
+  // logical volumes; UpdateGeometry refuses to rebuild while biasing is on,
+  // so this runs once per thread
+  if (fBiasMode == "none") return;
+  static G4ThreadLocal G4VBiasingOperator* biasingOperator = nullptr;
+  if (!biasingOperator) {
+    if (fBiasMode == "force") {
+      biasingOperator = new G4BOptrForceCollision("neutron", "ForceCollision");
+    } else {
+      biasingOperator = new CrystalBiasingOperator(this);
+    }
+  }
+  for (auto* volume : fLCrystals) biasingOperator->AttachTo(volume);
+}
+
+
 G4VPhysicalVolume* DetectorConstruction::ConstructVolumes(){
 
+  G4Timer timer;
+  timer.Start();
+  G4double memoryBefore = ProcessMemory::ResidentMB();
 
   Clean();
+  ResetVolumeLists();
+
+  // parameterised placements do not round-trip through GDML
+  G4String cacheFile = (fGeometryCacheDir.empty() || fUseLattice) ? G4String() : GetGeometryCacheFile();
+  if (!cacheFile.empty() && ReadGeometryCache(cacheFile)) {
+    timer.Stop();
+    G4cout << " Geometry read from cache " << cacheFile << " in "
+           << timer.GetRealElapsed() * 1000. << " ms" << G4endl;
+    AssignRegions();
+    ComputeBoundingSphere();
+    PrintParameters();
+    return fPWorld;
+  }
 
   G4Box* solidWorld = new G4Box("World", 0.5*fWorldLength, 0.5*fWorldLength, 0.5*fWorldLength);
   fLWorld = new G4LogicalVolume(solidWorld, fWorldMaterial, "World");
-  fPWorld = new G4PVPlacement(0, G4ThreeVector(), fLWorld, "World", 0, false, 0, true);
+  fLWorld->SetSmartless(fSmartless);
+  fPWorld = new G4PVPlacement(0, G4ThreeVector(), fLWorld, "World", 0, false, 0, fCheckOverlaps);
 
 
   // penultimate is copy number
   
-  PlaceBars();
+  if (fUseLattice) {
+    PlaceLattice();
+  } else {
+    PlaceBars();
+  }
+  fBuiltLattice = fUseLattice;
+  AssignRegions();
+  ComputeBoundingSphere();
 
   PrintParameters();
 
+  if (!cacheFile.empty()) WriteGeometryCache(cacheFile);
+
+  timer.Stop();
+  G4cout << " Geometry built in " << timer.GetRealElapsed() * 1000. << " ms: "
+         << G4PhysicalVolumeStore::GetInstance()->size() << " physical volumes, "
+         << G4LogicalVolumeStore::GetInstance()->size() << " logical volumes, "
+         << G4SolidStore::GetInstance()->size() << " solids, RSS change "
+         << ProcessMemory::ResidentMB() - memoryBefore << " MB" << G4endl;
 
   return fPWorld;
 }
@@ -265,25 +408,66 @@ void DetectorConstruction::PlaceBars(){
 
 void DetectorConstruction::ConstructBar(G4ThreeVector position, G4int barIndex) {
 
-    fLCover.push_back(CreateCover(position, barIndex));
+    // flat: crystals and grease sit in the world next to a hollow cover
+    // nested: they sit in an envelope daughter of a solid cover box
+    G4LogicalVolume* parentVolume = fLWorld;
+    G4ThreeVector parentOffset;
+    if (fNestedBars) {
+        parentVolume = CreateNestedCover(position, barIndex);
+        parentOffset = position;
+    } else {
+        fLCover.push_back(CreateCover(position, barIndex));
+    }
 
     for (G4int i = 0; i < fCrystalsPerBar; i++) {
         G4double crystalPositionY = (i - (fCrystalsPerBar - 1) / 2.0) * (fCrystalSize + fGreaseThickness);
         G4ThreeVector crystalPosition(position.x(), crystalPositionY, 0);
 
-        CreateCrystal(fLWorld, crystalPosition, barIndex, i);
+        CreateCrystal(parentVolume, crystalPosition - parentOffset, crystalPosition, barIndex, i);
         //CreateCrystal(fLCover.back(), crystalPosition, barIndex, i);
 
         if (i < fCrystalsPerBar - 1) {
             G4double greasePositionY = crystalPositionY + 0.5 * fCrystalSize + 0.5 * fGreaseThickness;
             G4ThreeVector greasePosition(position.x(), greasePositionY, 0);
-            CreateGrease(fLWorld, greasePosition, barIndex, i);
+            CreateGrease(parentVolume, greasePosition - parentOffset, barIndex, i);
             //CreateGrease(fLCover.back() , greasePosition, barIndex, i);
         }
     }
 }
 
 
+G4LogicalVolume* DetectorConstruction::CreateNestedCover(G4ThreeVector position, G4int barIndex) {
+
+    G4double totalBarLengthY = fCrystalsPerBar * fCrystalSize + (fCrystalsPerBar - 1) * fGreaseThickness;
+
+    // Solid cover box; like the hollow cover it is open at both ends in Y
+    G4double outerSizeX = fCrystalSize + fCoverThickness;
+    G4double outerSizeZ = fCrystalSize + fCoverThickness;
+
+    G4Box* solidCover = new G4Box("BarCover", 0.5 * outerSizeX, 0.5 * totalBarLengthY, 0.5 * outerSizeZ);
+    G4LogicalVolume* logicCover = new G4LogicalVolume(solidCover, fCoverMaterial, "LogicalCompleteCover_" + std::to_string(barIndex));
+    logicCover->SetSmartless(fSmartless);
+
+    G4VisAttributes* coverVisAtt = new G4VisAttributes(G4Colour(0.0, 1.0, 0.0, 0.6)); 
+    coverVisAtt->SetVisibility(true);
+    coverVisAtt->SetForceSolid(true); 
+    logicCover->SetVisAttributes(coverVisAtt);
+
+    new G4PVPlacement(0, position, logicCover, "PhysicalCompleteCover_" + std::to_string(barIndex), fLWorld, false, barIndex * 100 + 200, fCheckOverlaps);
+    fLCover.push_back(logicCover);
+
+    // Envelope filling the cover cavity, made of the world material
+    G4Box* solidEnvelope = new G4Box("BarEnvelope", 0.5 * fCrystalSize, 0.5 * totalBarLengthY, 0.5 * fCrystalSize);
+    G4LogicalVolume* logicEnvelope = new G4LogicalVolume(solidEnvelope, fWorldMaterial, "LogicalBarEnvelope_" + std::to_string(barIndex));
+    logicEnvelope->SetSmartless(fSmartless);
+    logicEnvelope->SetVisAttributes(G4VisAttributes::GetInvisible());
+
+    new G4PVPlacement(0, G4ThreeVector(), logicEnvelope, "PhysicalBarEnvelope_" + std::to_string(barIndex), logicCover, false, barIndex * 100 + 300, fCheckOverlaps);
+
+    return logicEnvelope;
+}
+
+
 G4LogicalVolume* DetectorConstruction::CreateCover(G4ThreeVector position, G4int barIndex) {
     
     G4double totalBarLengthY = fCrystalsPerBar * fCrystalSize + (fCrystalsPerBar - 1) * fGreaseThickness;
@@ -310,25 +494,26 @@ G4LogicalVolume* DetectorConstruction::CreateCover(G4ThreeVector position, G4int
     logicCompleteCover->SetVisAttributes(coverVisAtt);
 
     // Place the cover in the world volume
-    new G4PVPlacement(0, position, logicCompleteCover, "PhysicalCompleteCover_" + std::to_string(barIndex), fLWorld, false, barIndex * 100 + 200, true);
+    new G4PVPlacement(0, position, logicCompleteCover, "PhysicalCompleteCover_" + std::to_string(barIndex), fLWorld, false, barIndex * 100 + 200, fCheckOverlaps);
 
     return logicCompleteCover;
 }
 
 
 
-void DetectorConstruction::CreateCrystal(G4LogicalVolume* parentVolume, G4ThreeVector position, G4int barIndex, G4int crystalIndex) {
+void DetectorConstruction::CreateCrystal(G4LogicalVolume* parentVolume, G4ThreeVector position, G4ThreeVector globalPosition, G4int barIndex, G4int crystalIndex) {
 
   // store usefull datums
   scoringHandles.push_back("LogicalCrystal_" + std::to_string(barIndex) + "_" + std::to_string(crystalIndex));
-  scoringPlacements.push_back(position);
+  scoringPlacements.push_back(globalPosition);
   scoringSizes.push_back(G4ThreeVector(fCrystalSize,fCrystalSize,fCrystalSize));
   scoringMaterialNames.push_back(fCrystalMaterial->GetName());
 
   G4Box* solidCrystal = new G4Box("Crystal", 0.5 * scoringSizes.back().x(), 0.5 * scoringSizes.back().y(), 0.5 * scoringSizes.back().z());
   G4LogicalVolume* logicCrystal = new G4LogicalVolume(solidCrystal, fCrystalMaterial, scoringHandles.back());
-  new G4PVPlacement(0, scoringPlacements.back(), logicCrystal,"PhysicalCrystal_" + std::to_string(barIndex) + "_" + std::to_string(crystalIndex), parentVolume, false, barIndex * 100 + crystalIndex, true);
+  new G4PVPlacement(0, position, logicCrystal,"PhysicalCrystal_" + std::to_string(barIndex) + "_" + std::to_string(crystalIndex), parentVolume, false, barIndex * fCrystalsPerBar + crystalIndex, fCheckOverlaps);
   fLCrystals.push_back(logicCrystal);
+  fCrystalVolumes.insert(logicCrystal);
 }
 
 void DetectorConstruction::CreateGrease(G4LogicalVolume* parentVolume, G4ThreeVector position, G4int barIndex, G4int greaseIndex) {
@@ -336,13 +521,344 @@ void DetectorConstruction::CreateGrease(G4LogicalVolume* parentVolume, G4ThreeVe
   G4Box* solidGrease = new G4Box("Grease", 0.5 * fCrystalSize, 0.5 * fGreaseThickness, 0.5 * fCrystalSize);
   G4LogicalVolume* logicGrease = new G4LogicalVolume(solidGrease, fGreaseMaterial, "LogicalGrease_" + std::to_string(barIndex) + "_" + std::to_string(greaseIndex));
 
-  new G4PVPlacement(0, position, logicGrease, "PhysicalGrease_" + std::to_string(barIndex) + "_" + std::to_string(greaseIndex), parentVolume, false, barIndex * 100 + 50 + greaseIndex, true);
+  new G4PVPlacement(0, position, logicGrease, "PhysicalGrease_" + std::to_string(barIndex) + "_" + std::to_string(greaseIndex), parentVolume, false, barIndex * 100 + 50 + greaseIndex, fCheckOverlaps);
   fLGrease.push_back(logicGrease);
 }
 
 
 
+void DetectorConstruction::PlaceLattice(){
+
+  // crystals sit in a grease-filled envelope, so the gaps between them are grease
+  G4double pitch = fCrystalSize + fGreaseThickness;
+  G4double sizeX = fLatticeNx * pitch - fGreaseThickness;
+  G4double sizeY = fLatticeNy * pitch - fGreaseThickness;
+  G4double sizeZ = fLatticeNz * pitch - fGreaseThickness;
+
+  G4Box* solidEnvelope = new G4Box("LatticeEnvelope", 0.5 * sizeX, 0.5 * sizeY, 0.5 * sizeZ);
+  G4LogicalVolume* logicEnvelope = new G4LogicalVolume(solidEnvelope, fGreaseMaterial, "LogicalLatticeEnvelope");
+  logicEnvelope->SetSmartless(fSmartless);
+  new G4PVPlacement(0, G4ThreeVector(), logicEnvelope, "PhysicalLatticeEnvelope", fLWorld, false, 0, fCheckOverlaps);
+  fLGrease.push_back(logicEnvelope);
+
+  // one solid and one logical volume shared by every crystal
+  G4Box* solidCrystal = new G4Box("Crystal", 0.5 * fCrystalSize, 0.5 * fCrystalSize, 0.5 * fCrystalSize);
+  G4LogicalVolume* logicCrystal = new G4LogicalVolume(solidCrystal, fCrystalMaterial, "LogicalLatticeCrystal");
+
+  fLatticeParam = new CrystalLatticeParameterisation(fLatticeNx, fLatticeNy, fLatticeNz, pitch);
+  G4int nCrystals = fLatticeParam->GetNumberOfCrystals();
+  new G4PVParameterised("PhysicalLatticeCrystal", logicCrystal, logicEnvelope, kUndefined, nCrystals, fLatticeParam, fCheckOverlaps);
+  fLCrystals.push_back(logicCrystal);
+  fCrystalVolumes.insert(logicCrystal);
+
+  // store usefull datums, indexed by copy number
+  for (G4int copyNo = 0; copyNo < nCrystals; copyNo++) {
+    G4int ix, iy, iz;
+    fLatticeParam->GetIndices(copyNo, ix, iy, iz);
+    scoringHandles.push_back("LatticeCrystal_" + std::to_string(ix) + "_" + std::to_string(iy) + "_" + std::to_string(iz));
+    scoringPlacements.push_back(fLatticeParam->GetPosition(copyNo));
+    scoringSizes.push_back(G4ThreeVector(fCrystalSize, fCrystalSize, fCrystalSize));
+    scoringMaterialNames.push_back(fCrystalMaterial->GetName());
+  }
+}
+
+
+G4int DetectorConstruction::GetScoringIndex(const G4VTouchable* touchable) const {
+
+  const G4LogicalVolume* volume = touchable->GetVolume()->GetLogicalVolume();
+  if (fCrystalVolumes.find(volume) == fCrystalVolumes.end()) return -1;
+
+  // crystal copy numbers are the scoring index: barIndex * crystalsPerBar + crystalIndex
+  // for bars, the crystal ID for the lattice
+  G4int copyNo = touchable->GetCopyNumber();
+  if (copyNo < 0 || copyNo >= static_cast<G4int>(scoringHandles.size())) return -1;
+  return copyNo;
+}
+
+
+void DetectorConstruction::BenchmarkNavigation(G4int nRays) {
+
+  if (!fPWorld) {
+    G4cout << "\n--> warning from DetectorConstruction::BenchmarkNavigation : "
+           << "geometry not built, run /run/initialize first" << G4endl;
+    return;
+  }
+
+  // voxelisation is normally done at the first BeamOn; time it separately
+  G4Timer timer;
+  timer.Start();
+  G4GeometryManager::GetInstance()->CloseGeometry(true);
+  timer.Stop();
+  G4double closeTime = timer.GetRealElapsed();
+
+  G4Navigator navigator;
+  navigator.SetWorldVolume(fPWorld);
+
+  // straight rays from the edge of the world aimed through the central region
+  G4double halfWorld = 0.5 * fWorldLength;
+  G4long nSteps = 0;
+
+  timer.Start();
+  for (G4int i = 0; i < nRays; i++) {
+    G4ThreeVector point = 0.99 * halfWorld * G4RandomDirection();
+    G4ThreeVector target((G4UniformRand() - 0.5) * halfWorld,
+                         (G4UniformRand() - 0.5) * halfWorld,
+                         (G4UniformRand() - 0.5) * halfWorld);
+    G4ThreeVector direction = (target - point).unit();
+
+    navigator.LocateGlobalPointAndSetup(point, &direction, false, false);
+    for (G4int iStep = 0; iStep < 1000000; iStep++) {
+      G4double safety = 0.;
+      G4double step = navigator.ComputeStep(point, direction, kInfinity, safety);
+      if (step == kInfinity) break;
+      point += step * direction;
+      navigator.SetGeometricallyLimitedStep();
+      nSteps++;
+      if (!navigator.LocateGlobalPointAndSetup(point, &direction, true)) break;  // left the world
+    }
+  }
+  timer.Stop();
+
+  G4double navTime = timer.GetRealElapsed();
+  G4cout << " ============================================ " << G4endl;
+  G4cout << " Navigation benchmark" << G4endl;
+  G4cout << " Layout: " << (fUseLattice ? "lattice" : (fNestedBars ? "nested bars" : "flat bars")) << G4endl;
+  G4cout << " Smartless: " << fSmartless << G4endl;
+  G4cout << " Voxelisation: " << closeTime * 1000. << " ms" << G4endl;
+  G4cout << " Rays: " << nRays << ", steps: " << nSteps << G4endl;
+  G4cout << " Time: " << navTime << " s, "
+         << (navTime > 0. ? nSteps / navTime : 0.) << " steps/s" << G4endl;
+  G4cout << " RSS: " << ProcessMemory::ResidentMB() << " MB" << G4endl;
+  G4cout << " ============================================ " << G4endl;
+}
+
+
+G4String DetectorConstruction::GetGeometryCacheFile() const {
+
+  // every parameter that changes the volume tree goes into the key, and a tag
+  // for the copy-number scheme so caches written by older builds are not reused
+  std::ostringstream key;
+  key << std::setprecision(17) << "copy-v2|"
+      << fWorldLength << '|' << fCrystalSize << '|' << fGreaseThickness << '|'
+      << fCoverThickness << '|' << fBarSpacing << '|' << fNumberOfBars << '|'
+      << fCrystalsPerBar << '|' << fNestedBars << '|' << fSmartless << '|'
+      << (fWorldMaterial ? fWorldMaterial->GetName() : "") << '|'
+      << (fCrystalMaterial ? fCrystalMaterial->GetName() : "") << '|'
+      << (fGreaseMaterial ? fGreaseMaterial->GetName() : "") << '|'
+      << (fCoverMaterial ? fCoverMaterial->GetName() : "");
+
+  std::ostringstream name;
+  name << fGeometryCacheDir << "/geometry_" << std::hex << std::setw(16) << std::setfill('0')
+       << HashString(key.str()) << ".gdml";
+  return name.str();
+}
+
+
+G4bool DetectorConstruction::ReadGeometryCache(const G4String& fileName) {
+#ifdef TEXNEUTSIM_USE_GDML
+  if (!std::ifstream(fileName).good()) return false;
+
+  G4GDMLParser parser;
+  parser.Read(fileName, false);
+  fPWorld = parser.GetWorldVolume();
+  if (!fPWorld) return false;
+  fLWorld = fPWorld->GetLogicalVolume();
+  fLWorld->SetSmartless(fSmartless);
+
+  // recover the volume lists and scoring tables from the imported tree;
+  // GDML keeps neither the voxel density nor the vis attributes
+  G4VisAttributes* coverVisAtt = nullptr;
+  for (auto* volume : *G4LogicalVolumeStore::GetInstance()) {
+    const G4String& name = volume->GetName();
+    if (name.rfind("LogicalCrystal_", 0) == 0) {
+      fLCrystals.push_back(volume);
+      fCrystalVolumes.insert(volume);
+    } else if (name.rfind("LogicalGrease_", 0) == 0) {
+      fLGrease.push_back(volume);
+    } else if (name.rfind("LogicalCompleteCover_", 0) == 0) {
+      fLCover.push_back(volume);
+      if (!coverVisAtt) {
+        coverVisAtt = new G4VisAttributes(G4Colour(0.0, 1.0, 0.0, 0.6));
+        coverVisAtt->SetVisibility(true);
+        coverVisAtt->SetForceSolid(true);
+      }
+      volume->SetVisAttributes(coverVisAtt);
+      volume->SetSmartless(fSmartless);
+    } else if (name.rfind("LogicalBarEnvelope_", 0) == 0) {
+      volume->SetVisAttributes(G4VisAttributes::GetInvisible());
+      volume->SetSmartless(fSmartless);
+    }
+  }
+  fBuiltLattice = false;
+
+  G4int nScoring = fNumberOfBars * fCrystalsPerBar;
+  scoringHandles.assign(nScoring, "");
+  scoringPlacements.assign(nScoring, G4ThreeVector());
+  scoringSizes.assign(nScoring, G4ThreeVector());
+  scoringMaterialNames.assign(nScoring, "");
+  FillScoringTables(fLWorld, G4ThreeVector());
+  return true;
+#else
+  (void)fileName;
+  return false;
+#endif
+}
+
+
+void DetectorConstruction::FillScoringTables(G4LogicalVolume* mother, G4ThreeVector offset) {
+  // only translations are used when building bars
+  for (std::size_t i = 0; i < mother->GetNoDaughters(); i++) {
+    G4VPhysicalVolume* daughter = mother->GetDaughter(i);
+    G4LogicalVolume* volume = daughter->GetLogicalVolume();
+    G4ThreeVector position = offset + daughter->GetTranslation();
+
+    if (fCrystalVolumes.count(volume)) {
+      G4int index = daughter->GetCopyNo();
+      if (index < 0 || index >= static_cast<G4int>(scoringHandles.size())) {
+        G4cout << "\n--> warning from DetectorConstruction::FillScoringTables : "
+               << "crystal " << volume->GetName() << " has copy number " << index
+               << " outside the " << scoringHandles.size() << " scoring volumes, not scored" << G4endl;
+        continue;
+      }
+      G4Box* box = static_cast<G4Box*>(volume->GetSolid());
+      scoringHandles[index] = volume->GetName();
+      scoringPlacements[index] = position;
+      scoringSizes[index] = 2. * G4ThreeVector(box->GetXHalfLength(), box->GetYHalfLength(), box->GetZHalfLength());
+      scoringMaterialNames[index] = volume->GetMaterial()->GetName();
+    } else {
+      FillScoringTables(volume, position);
+    }
+  }
+}
+
+
+void DetectorConstruction::WriteGeometryCache(const G4String& fileName) {
+#ifdef TEXNEUTSIM_USE_GDML
+  if (std::ifstream(fileName).good()) return;
+  std::error_code error;
+  std::filesystem::create_directories(fGeometryCacheDir.c_str(), error);
+  G4GDMLParser parser;
+  parser.Write(fileName, fPWorld, true);
+#else
+  G4cout << "\n--> warning from DetectorConstruction::WriteGeometryCache : "
+         << "built without GDML support, geometry not cached" << G4endl;
+  (void)fileName;
+#endif
+}
+
+
+void DetectorConstruction::RunOverlapCheck(G4int resolution) {
+
+  if (!fPWorld) {
+    G4cout << "\n--> warning from DetectorConstruction::RunOverlapCheck : "
+           << "geometry not built, run /run/initialize first" << G4endl;
+    return;
+  }
+
+  // serial: solids fill their caches lazily and are not re-entrant, and
+  // parameterised volumes move their single physical volume per copy
+  G4Timer timer;
+  timer.Start();
+
+  std::size_t nVolumes = 0;
+  G4int nOverlaps = 0;
+  for (auto* volume : *G4PhysicalVolumeStore::GetInstance()) {
+    if (volume == fPWorld) continue;
+    nVolumes++;
+    if (volume->CheckOverlaps(resolution, 0., false, 1)) nOverlaps++;
+  }
+
+  timer.Stop();
+  G4cout << " ============================================ " << G4endl;
+  G4cout << " Overlap check: " << nVolumes << " volumes, " << resolution << " points each" << G4endl;
+  G4cout << " Volumes with overlaps: " << nOverlaps << G4endl;
+  G4cout << " Time: " << timer.GetRealElapsed() << " s" << G4endl;
+  G4cout << " ============================================ " << G4endl;
+}
+
+
+void DetectorConstruction::ResetVolumeLists(){
+
+  // the stores have been cleaned: drop every pointer and table from the last build
+  fLWorld = nullptr;
+  fPWorld = nullptr;
+  fLCrystals.clear();
+  fLGrease.clear();
+  fLCover.clear();
+  fCrystalVolumes.clear();
+  delete fLatticeParam;
+  fLatticeParam = nullptr;
+
+  scoringHandles.clear();
+  scoringPlacements.clear();
+  scoringSizes.clear();
+  scoringMaterialNames.clear();
+}
+
+
+void DetectorConstruction::UpdateGeometry(){
+
+  // G4VBiasingOperator cannot be detached from a volume: the deleted
+  // crystals would stay in its volume map, and a new volume allocated at
+  // a freed address would silently inherit the biasing
+  if (fBiasMode != "none") {
+    G4cout << "\n--> warning from DetectorConstruction::UpdateGeometry : "
+           << "the geometry cannot be rebuilt with /detector/biasMode " << fBiasMode
+           << "; command ignored" << G4endl;
+    return;
+  }
+
+  // Construct() is called again at the next BeamOn; physics tables are kept
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+
+void DetectorConstruction::AssignRegions(){
+
+  // Production cuts are set per region by the PhysicsList. Everything not
+  // listed here (world, nested bar envelopes) stays in the default region
+  // or inherits the region of its mother.
+  auto attach = [](const char* regionName, const std::vector<G4LogicalVolume*>& volumes) {
+    G4Region* region = G4RegionStore::GetInstance()->FindOrCreateRegion(regionName);
+    for (auto* volume : volumes) region->AddRootLogicalVolume(volume);
+  };
+  attach(kCrystalRegion, fLCrystals);
+  attach(kGreaseRegion, fLGrease);
+  attach(kCoverRegion, fLCover);
+}
+
+
+void DetectorConstruction::ComputeBoundingSphere(){
+
+  // bounding box of the crystals, grown by the cover on every side
+  if (scoringPlacements.empty()) {
+    fBoundingCentre = G4ThreeVector();
+    fBoundingRadius = 0.;
+    return;
+  }
+  G4ThreeVector low(kInfinity, kInfinity, kInfinity), high(-kInfinity, -kInfinity, -kInfinity);
+  for (size_t i = 0; i < scoringPlacements.size(); i++) {
+    for (G4int k = 0; k < 3; k++) {
+      low[k] = std::min(low[k], scoringPlacements[i][k] - 0.5 * scoringSizes[i][k] - fCoverThickness);
+      high[k] = std::max(high[k], scoringPlacements[i][k] + 0.5 * scoringSizes[i][k] + fCoverThickness);
+    }
+  }
+  fBoundingCentre = 0.5 * (low + high);
+  fBoundingRadius = 0.5 * (high - low).mag();
+}
+
+
 void DetectorConstruction::Clean(){
+
+  // detach the old root volumes before the stores delete them
+  for (const char* regionName : {kCrystalRegion, kGreaseRegion, kCoverRegion}) {
+    G4Region* region = G4RegionStore::GetInstance()->GetRegion(regionName, false);
+    if (!region) continue;
+    std::vector<G4LogicalVolume*> roots(region->GetRootLogicalVolumeIterator(),
+                                        region->GetRootLogicalVolumeIterator() + region->GetNumberOfRootVolumes());
+    for (auto* volume : roots) region->RemoveRootLogicalVolume(volume, false);
+  }
+
   G4GeometryManager::GetInstance()->OpenGeometry();
   G4PhysicalVolumeStore::GetInstance()->Clean();
   G4LogicalVolumeStore::GetInstance()->Clean();
@@ -362,8 +878,13 @@ void DetectorConstruction::PrintParameters() {
     G4cout << " Crystal Material: " << (fCrystalMaterial ? fCrystalMaterial->GetName() : "Not defined") << G4endl;
     G4cout << " Grease Material: " << (fGreaseMaterial ? fGreaseMaterial->GetName() : "Not defined") << G4endl;
     G4cout << " Cover Material: " << (fCoverMaterial ? fCoverMaterial->GetName() : "Not defined") << G4endl;
-    G4cout << " Number of Bars: " << fNumberOfBars << G4endl;
-    G4cout << " Crystals per Bar: " << fCrystalsPerBar << G4endl;
+    if (fUseLattice) {
+      G4cout << " Lattice: " << fLatticeNx << " x " << fLatticeNy << " x " << fLatticeNz << G4endl;
+    } else {
+      G4cout << " Number of Bars: " << fNumberOfBars << G4endl;
+      G4cout << " Crystals per Bar: " << fCrystalsPerBar << G4endl;
+      G4cout << " Bar Layout: " << (fNestedBars ? "nested" : "flat") << G4endl;
+    }
     G4cout << " Crystal Size: " << fCrystalSize / cm << " cm" << G4endl;
     G4cout << " Grease Thickness: " << fGreaseThickness / mm << " mm" << G4endl;
     G4cout << " Bar Spacing: " << fBarSpacing / cm << " cm" << G4endl;
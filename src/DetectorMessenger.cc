@@ -9,6 +9,9 @@
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWithoutParameter.hh"
 #include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include <sstream>
 
 
 
@@ -83,6 +86,100 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction* Det)
   fWorldSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
 
+  fUpdateCmd = new G4UIcmdWithoutParameter("/detector/update", this);
+  fUpdateCmd->SetGuidance("Rebuild the geometry with the current parameters.");
+  fUpdateCmd->SetGuidance("Takes effect at the next /run/beamOn, without re-initialising physics.");
+  fUpdateCmd->SetGuidance("Refused while /detector/biasMode is not none.");
+  fUpdateCmd->AvailableForStates(G4State_Idle);
+
+  fCheckOverlapsCmd = new G4UIcmdWithABool("/detector/checkOverlaps", this);
+  fCheckOverlapsCmd->SetGuidance("Check overlaps of every placement while building (slow for large arrays).");
+  fCheckOverlapsCmd->SetParameterName("flag", false);
+  fCheckOverlapsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRunOverlapCheckCmd = new G4UIcommand("/detector/runOverlapCheck", this);
+  fRunOverlapCheckCmd->SetGuidance("Check all placed volumes for overlaps, one after the other.");
+  fRunOverlapCheckCmd->SetGuidance("Use with /detector/checkOverlaps false to defer the check.");
+  G4UIparameter* resPrm = new G4UIparameter("resolution", 'i', true);
+  resPrm->SetDefaultValue(1000);
+  resPrm->SetParameterRange("resolution>0");
+  fRunOverlapCheckCmd->SetParameter(resPrm);
+  fRunOverlapCheckCmd->AvailableForStates(G4State_Idle);
+
+  fGeometryCacheCmd = new G4UIcmdWithAString("/detector/geometryCache", this);
+  fGeometryCacheCmd->SetGuidance("Directory for GDML geometry caches keyed by the geometry parameters.");
+  fGeometryCacheCmd->SetGuidance("A cached geometry is read instead of built. Empty string disables.");
+  fGeometryCacheCmd->SetParameterName("dir", true);
+  fGeometryCacheCmd->SetDefaultValue("");
+  fGeometryCacheCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fNestedBarsCmd = new G4UIcmdWithABool("/detector/useNestedBars", this);
+  fNestedBarsCmd->SetGuidance("Place crystals and grease inside an envelope daughter of a solid cover box,");
+  fNestedBarsCmd->SetGuidance("instead of in the world next to a G4SubtractionSolid cover.");
+  fNestedBarsCmd->SetParameterName("flag", false);
+  fNestedBarsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSmartlessCmd = new G4UIcmdWithADouble("/detector/setSmartless", this);
+  fSmartlessCmd->SetGuidance("Set the voxelisation quality (smartless) of the world and mother volumes.");
+  fSmartlessCmd->SetParameterName("smartless", false);
+  fSmartlessCmd->SetRange("smartless>0");
+  fSmartlessCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fUseLatticeCmd = new G4UIcmdWithABool("/detector/useLattice", this);
+  fUseLatticeCmd->SetGuidance("Build a 3D crystal lattice instead of bars.");
+  fUseLatticeCmd->SetGuidance("All crystals share one solid and logical volume (parameterised placement).");
+  fUseLatticeCmd->SetParameterName("flag", false);
+  fUseLatticeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fLatticeSizeCmd = new G4UIcommand("/detector/setLatticeSize", this);
+  fLatticeSizeCmd->SetGuidance("Set number of lattice crystals along x, y and z.");
+  G4UIparameter* nxPrm = new G4UIparameter("nx", 'i', false);
+  nxPrm->SetParameterRange("nx>0");
+  fLatticeSizeCmd->SetParameter(nxPrm);
+  G4UIparameter* nyPrm = new G4UIparameter("ny", 'i', false);
+  nyPrm->SetParameterRange("ny>0");
+  fLatticeSizeCmd->SetParameter(nyPrm);
+  G4UIparameter* nzPrm = new G4UIparameter("nz", 'i', false);
+  nzPrm->SetParameterRange("nz>0");
+  fLatticeSizeCmd->SetParameter(nzPrm);
+  fLatticeSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBenchmarkNavigationCmd = new G4UIcmdWithAnInteger("/detector/benchmarkNavigation", this);
+  fBenchmarkNavigationCmd->SetGuidance("Trace straight rays through the geometry and report steps/s.");
+  fBenchmarkNavigationCmd->SetParameterName("nRays", true);
+  fBenchmarkNavigationCmd->SetDefaultValue(100000);
+  fBenchmarkNavigationCmd->SetRange("nRays>0");
+  fBenchmarkNavigationCmd->AvailableForStates(G4State_Idle);
+
+  fRecoilFastSimCmd = new G4UIcmdWithABool("/detector/recoilFastSim", this);
+  fRecoilFastSimCmd->SetGuidance("Attach the recoil fast simulation model to the crystal region.");
+  fRecoilFastSimCmd->SetGuidance("Requires /physics/enable fastSimulation; toggle at run time");
+  fRecoilFastSimCmd->SetGuidance("with /param/activateModel and /param/inActivateModel RecoilFastSim.");
+  fRecoilFastSimCmd->SetParameterName("flag", false);
+  fRecoilFastSimCmd->AvailableForStates(G4State_PreInit);
+
+  fRecoilSafetyFractionCmd = new G4UIcmdWithADouble("/detector/recoilSafetyFraction", this);
+  fRecoilSafetyFractionCmd->SetGuidance("A recoil is deposited in one step if its range is below");
+  fRecoilSafetyFractionCmd->SetGuidance("this fraction of the distance to the nearest crystal surface.");
+  fRecoilSafetyFractionCmd->SetParameterName("fraction", false);
+  fRecoilSafetyFractionCmd->SetRange("fraction>0. && fraction<=1.");
+  fRecoilSafetyFractionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBiasModeCmd = new G4UIcmdWithAString("/detector/biasMode", this);
+  fBiasModeCmd->SetGuidance("Neutron interaction biasing in the crystals (needs /physics/enable biasing).");
+  fBiasModeCmd->SetGuidance("  scale: cross sections multiplied by /detector/biasScale");
+  fBiasModeCmd->SetGuidance("  force: one interaction forced in every crystal crossed");
+  fBiasModeCmd->SetGuidance("The geometry cannot be rebuilt with /detector/update while biasing is on.");
+  fBiasModeCmd->SetParameterName("mode", false);
+  fBiasModeCmd->SetCandidates("none scale force");
+  fBiasModeCmd->AvailableForStates(G4State_PreInit);
+
+  fBiasScaleCmd = new G4UIcmdWithADouble("/detector/biasScale", this);
+  fBiasScaleCmd->SetGuidance("Neutron cross-section factor in the crystals for biasMode scale.");
+  fBiasScaleCmd->SetParameterName("scale", false);
+  fBiasScaleCmd->SetRange("scale>0.");
+  fBiasScaleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
 }
 DetectorMessenger::~DetectorMessenger()
 {
@@ -92,6 +189,19 @@ DetectorMessenger::~DetectorMessenger()
   delete fSetCrystalMaterialCmd;
   delete fSetGreaseMaterialCmd;
   delete fSetCoverMaterialCmd;
+  delete fUpdateCmd;
+  delete fCheckOverlapsCmd;
+  delete fRunOverlapCheckCmd;
+  delete fGeometryCacheCmd;
+  delete fNestedBarsCmd;
+  delete fSmartlessCmd;
+  delete fUseLatticeCmd;
+  delete fLatticeSizeCmd;
+  delete fBenchmarkNavigationCmd;
+  delete fRecoilFastSimCmd;
+  delete fRecoilSafetyFractionCmd;
+  delete fBiasModeCmd;
+  delete fBiasScaleCmd;
   delete fDetDir;
 }
 
@@ -135,6 +245,38 @@ void DetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
     fDetector->SetCoverThickness(fBarSpacingCmd->GetNewDoubleValue(newValue));
   }else if (command == fWorldSizeCmd) {
     fDetector->SetWorldSize(fBarSpacingCmd->GetNewDoubleValue(newValue));
+  }else if (command == fUpdateCmd) {
+    fDetector->UpdateGeometry();
+  }else if (command == fCheckOverlapsCmd) {
+    fDetector->SetCheckOverlaps(fCheckOverlapsCmd->GetNewBoolValue(newValue));
+  }else if (command == fRunOverlapCheckCmd) {
+    G4int resolution = 1000;
+    std::istringstream is(newValue);
+    is >> resolution;
+    fDetector->RunOverlapCheck(resolution);
+  }else if (command == fGeometryCacheCmd) {
+    fDetector->SetGeometryCacheDir(newValue);
+  }else if (command == fNestedBarsCmd) {
+    fDetector->SetNestedBars(fNestedBarsCmd->GetNewBoolValue(newValue));
+  }else if (command == fSmartlessCmd) {
+    fDetector->SetSmartless(fSmartlessCmd->GetNewDoubleValue(newValue));
+  }else if (command == fUseLatticeCmd) {
+    fDetector->SetUseLattice(fUseLatticeCmd->GetNewBoolValue(newValue));
+  }else if (command == fLatticeSizeCmd) {
+    G4int nx, ny, nz;
+    std::istringstream is(newValue);
+    is >> nx >> ny >> nz;
+    fDetector->SetLatticeSize(nx, ny, nz);
+  }else if (command == fBenchmarkNavigationCmd) {
+    fDetector->BenchmarkNavigation(fBenchmarkNavigationCmd->GetNewIntValue(newValue));
+  }else if (command == fRecoilFastSimCmd) {
+    fDetector->SetRecoilFastSim(fRecoilFastSimCmd->GetNewBoolValue(newValue));
+  }else if (command == fRecoilSafetyFractionCmd) {
+    fDetector->SetRecoilSafetyFraction(fRecoilSafetyFractionCmd->GetNewDoubleValue(newValue));
+  }else if (command == fBiasModeCmd) {
+    fDetector->SetBiasMode(newValue);
+  }else if (command == fBiasScaleCmd) {
+    fDetector->SetBiasScale(fBiasScaleCmd->GetNewDoubleValue(newValue));
   }
 
 
@@ -0,0 +1,433 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file DetectorResponse.cc
+/// \brief Implementation of the DetectorResponse class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "DetectorResponse.hh"
+#include "DetectorResponseMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "EventSchema.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4Proton.hh"
+#include "G4Deuteron.hh"
+#include "G4Triton.hh"
+#include "G4He3.hh"
+#include "G4Alpha.hh"
+#include "G4IonTable.hh"
+#include "G4EmCalculator.hh"
+#include "G4Material.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "G4Poisson.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/RandBinomial.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+static_assert(DetectorResponse::kNumberOfSpecies == EventSchema::kNumberOfSpecies,
+              "the species columns of the output follow DetectorResponse::Species");
+
+namespace
+{
+  // FNV-1a, as for the geometry cache
+  std::uint64_t HashString(const std::string& text) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorResponse::DetectorResponse(const DetectorConstruction* detector)
+ : fDetector(detector)
+{
+  // a single Birks constant typical of organic scintillators
+  for (auto& birks : fBirks) {
+    birks.kB = 0.126 * mm / MeV;
+    birks.C = 0.;
+  }
+
+  // pulse shape of a fast organic scintillator
+  fFastTime = 3.7 * ns;
+  fSlowTime = 120. * ns;
+  fTailStart = 20. * ns;
+  fGate = 200. * ns;
+  fSlowFraction[kElectron] = 0.10;
+  fSlowFraction[kProton] = 0.25;
+  fSlowFraction[kAlpha] = 0.35;
+  fSlowFraction[kIon] = 0.40;
+  UpdatePulseIntegrals();
+
+  fMessenger = new DetectorResponseMessenger(this);
+}
+
+DetectorResponse::~DetectorResponse()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorResponse::Species DetectorResponse::GetSpecies(const G4ParticleDefinition* particle)
+{
+  if (particle->GetPDGCharge() == 0.) return kElectron;
+  if (particle == G4Electron::Definition() || particle == G4Positron::Definition()) return kElectron;
+  if (particle == G4Alpha::Definition() || particle == G4He3::Definition()) return kAlpha;
+  if (particle->GetParticleType() == "nucleus" && particle != G4Proton::Definition()
+      && particle != G4Deuteron::Definition() && particle != G4Triton::Definition()) return kIon;
+  if (particle->GetParticleType() == "lepton") return kElectron;
+  return kProton;
+}
+
+
+const char* DetectorResponse::GetSpeciesName(Species species)
+{
+  static const char* names[kNumberOfSpecies] = {"electron", "proton", "alpha", "ion"};
+  return names[species];
+}
+
+
+void DetectorResponse::SetBirks(Species species, G4double kB, G4double C)
+{
+  fBirks[species].kB = kB;
+  fBirks[species].C = C;
+  fStoppingLight.clear();   // stale until the next PrepareStoppingLight
+}
+
+
+void DetectorResponse::Print() const
+{
+  G4cout << " ============ Detector response ============ " << G4endl;
+  G4cout << " Birks/Chou quenching: " << (fQuenching ? "on" : "off") << G4endl;
+  for (G4int i = 0; i < kNumberOfSpecies; i++) {
+    G4cout << "  " << GetSpeciesName(static_cast<Species>(i))
+           << ": kB = " << fBirks[i].kB / (mm / MeV) << " mm/MeV, C = "
+           << fBirks[i].C / (mm * mm / (MeV * MeV)) << " (mm/MeV)^2" << G4endl;
+  }
+  G4cout << " Light collection: " << (fLightCollection ? "on" : "off") << G4endl;
+  if (fLightCollection) {
+    G4cout << "  n crystal " << fOptics.crystalIndex << ", n grease " << fOptics.greaseIndex
+           << ", cover reflectivity " << fOptics.coverReflectivity << ", attenuation length "
+           << G4BestUnit(fOptics.attenuationLength, "Length") << G4endl;
+    G4cout << "  " << fPhotonsPerMeV << " photons/MeVee, detection efficiency " << fDetectionEfficiency
+           << ", map " << fMapBins << "^3 bins x " << fMapPhotonsPerBin << " photons, cache "
+           << (fMapCacheDir.empty() ? G4String("none") : fMapCacheDir) << G4endl;
+    if (fMap.IsValid()) G4cout << "  mean collection efficiency " << fMap.GetMeanEfficiency() << G4endl;
+  }
+  G4cout << " Pulse shape: decay " << G4BestUnit(fFastTime, "Time") << " / " << G4BestUnit(fSlowTime, "Time")
+         << ", tail from " << G4BestUnit(fTailStart, "Time") << " to " << G4BestUnit(fGate, "Time") << G4endl;
+  for (G4int i = 0; i < kNumberOfSpecies; i++) {
+    G4cout << "  " << GetSpeciesName(static_cast<Species>(i)) << ": slow fraction " << fSlowFraction[i]
+           << ", tail/total " << fTailIntegral[i] / fTotalIntegral[i] << G4endl;
+  }
+  if (fBuilder.enabled) {
+    G4cout << " Event building: integration " << G4BestUnit(fBuilder.integrationTime, "Time")
+           << ", dead time " << G4BestUnit(fBuilder.deadTime, "Time")
+           << ", coincidence window " << G4BestUnit(fBuilder.coincidenceWindow, "Time") << G4endl;
+  }
+  G4cout << " =========================================== " << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DetectorResponse::Quench(Species species, G4double dEdx) const
+{
+  if (!fQuenching) return 1.;
+  const Birks& birks = fBirks[species];
+  return 1. / (1. + birks.kB * dEdx + birks.C * dEdx * dEdx);
+}
+
+
+G4double DetectorResponse::StepLight(Species species, G4double edep, G4double stepLength) const
+{
+  if (edep <= 0.) return 0.;
+  if (stepLength <= 0.) return edep;
+  return edep * Quench(species, edep / stepLength);
+}
+
+
+G4double DetectorResponse::StepLight(const G4ParticleDefinition* particle, const G4Material* material,
+                                     Species species, G4double edep, G4double stepLength,
+                                     G4double preEnergy, G4double postEnergy) const
+{
+  // the mean dE/dx of a step that ends in the Bragg peak is far below the
+  // dE/dx the particle actually had there, and overestimates the light
+  G4double loss = preEnergy - postEnergy;
+  if (edep > 0. && fQuenching && species != kElectron && loss > 0. && preEnergy <= fLightTableMax
+      && (postEnergy <= 0. || loss > fRangeLimitedLoss * preEnergy)) {
+    if (const StoppingLightTable* table = FindStoppingLight(particle, material)) {
+      G4double light = TableLight(*table, preEnergy) - (postEnergy > 0. ? TableLight(*table, postEnergy) : 0.);
+      return edep * light / loss;
+    }
+  }
+  return StepLight(species, edep, stepLength);
+}
+
+
+G4double DetectorResponse::StoppingLight(const G4ParticleDefinition* particle, const G4Material* material,
+                                         G4double energy) const
+{
+  if (energy <= 0.) return 0.;
+  if (!fQuenching) return energy;
+
+  // above the grid: the direct integration
+  if (energy <= fLightTableMax) {
+    if (const StoppingLightTable* table = FindStoppingLight(particle, material)) return TableLight(*table, energy);
+  }
+  return IntegrateStoppingLight(particle, material, energy);
+}
+
+
+const DetectorResponse::StoppingLightTable*
+DetectorResponse::FindStoppingLight(const G4ParticleDefinition* particle, const G4Material* material) const
+{
+  for (const auto& table : fStoppingLight) {
+    if (table.particle == particle && table.material == material) return &table;
+  }
+  return nullptr;
+}
+
+
+G4double DetectorResponse::TableLight(const StoppingLightTable& table, G4double energy) const
+{
+  // linear in log(energy) between the grid points; below the grid the
+  // ratio of its first point
+  G4double logStep = std::log(fLightTableMax / fLightTableMin) / (fLightTableBins - 1);
+  G4double x = std::log(energy / fLightTableMin) / logStep;
+  if (x <= 0.) return energy * table.lightRatio.front();
+  G4int bin = std::min(static_cast<G4int>(x), fLightTableBins - 2);
+  G4double f = x - bin;
+  return energy * ((1. - f) * table.lightRatio[bin] + f * table.lightRatio[bin + 1]);
+}
+
+
+void DetectorResponse::PrepareStoppingLight()
+{
+  fStoppingLight.clear();
+  if (!fQuenching) return;
+
+  // the recoil nuclei of every element of the crystal materials, and alphas
+  std::vector<const G4Material*> materials;
+  for (const auto& name : fDetector->scoringMaterialNames) {
+    const G4Material* material = G4Material::GetMaterial(name, false);
+    if (material && std::find(materials.begin(), materials.end(), material) == materials.end()) {
+      materials.push_back(material);
+    }
+  }
+
+  G4EmCalculator calculator;
+  G4double logStep = std::log(fLightTableMax / fLightTableMin) / (fLightTableBins - 1);
+  for (const G4Material* material : materials) {
+    std::vector<const G4ParticleDefinition*> particles = {G4Alpha::Definition()};
+    for (const G4Element* element : *material->GetElementVector()) {
+      G4int Z = G4lrint(element->GetZ());
+      G4int A = G4lrint(element->GetN());
+      const G4ParticleDefinition* recoil = (Z == 1 && A == 1) ? G4Proton::Definition()
+        : G4IonTable::GetIonTable()->GetIon(Z, A);
+      if (recoil && std::find(particles.begin(), particles.end(), recoil) == particles.end()) {
+        particles.push_back(recoil);
+      }
+    }
+
+    // cumulative light on the grid: the first point by direct integration,
+    // then one midpoint step per bin, as for the fast engine
+    for (const G4ParticleDefinition* particle : particles) {
+      StoppingLightTable table{particle, material, std::vector<G4double>(fLightTableBins)};
+      Species species = GetSpecies(particle);
+      G4double previous = fLightTableMin;
+      G4double light = IntegrateStoppingLight(particle, material, previous);
+      table.lightRatio[0] = light / previous;
+      for (G4int bin = 1; bin < fLightTableBins; bin++) {
+        G4double energy = fLightTableMin * std::exp(bin * logStep);
+        G4double dEdx = calculator.ComputeTotalDEDX(0.5 * (previous + energy), particle, material);
+        light += (energy - previous) * Quench(species, dEdx);
+        table.lightRatio[bin] = light / energy;
+        previous = energy;
+      }
+      fStoppingLight.push_back(std::move(table));
+    }
+  }
+}
+
+
+G4double DetectorResponse::IntegrateStoppingLight(const G4ParticleDefinition* particle, const G4Material* material,
+                                                  G4double energy) const
+{
+  // the calculator keeps per-call state, so one per thread
+  static G4ThreadLocal G4EmCalculator* calculator = nullptr;
+  if (!calculator) calculator = new G4EmCalculator();
+
+  // midpoint rule in energy; the Bragg peak of MeV recoils lies within
+  // the first few bins and is resolved by their midpoints
+  Species species = GetSpecies(particle);
+  G4double step = energy / fIntegrationSteps;
+  G4double light = 0.;
+  for (G4int i = 0; i < fIntegrationSteps; i++) {
+    G4double dEdx = calculator->ComputeTotalDEDX((i + 0.5) * step, particle, material);
+    light += step * Quench(species, dEdx);
+  }
+  return light;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorResponse::SetDecayTimes(G4double fast, G4double slow)
+{
+  fFastTime = fast;
+  fSlowTime = slow;
+  UpdatePulseIntegrals();
+}
+
+
+void DetectorResponse::SetGate(G4double tailStart, G4double gate)
+{
+  fTailStart = tailStart;
+  fGate = gate;
+  UpdatePulseIntegrals();
+}
+
+
+void DetectorResponse::SetSlowFraction(Species species, G4double fraction)
+{
+  fSlowFraction[species] = fraction;
+  UpdatePulseIntegrals();
+}
+
+
+void DetectorResponse::UpdatePulseIntegrals()
+{
+  // a unit of light split into normalised exponentials, integrated over
+  // the tail window and over the whole gate
+  auto window = [](G4double tau, G4double from, G4double to) {
+    return std::exp(-from / tau) - std::exp(-to / tau);
+  };
+  for (G4int i = 0; i < kNumberOfSpecies; i++) {
+    G4double slow = fSlowFraction[i];
+    fTailIntegral[i] = (1. - slow) * window(fFastTime, fTailStart, fGate)
+                     + slow * window(fSlowTime, fTailStart, fGate);
+    fTotalIntegral[i] = (1. - slow) * window(fFastTime, 0., fGate)
+                      + slow * window(fSlowTime, 0., fGate);
+  }
+}
+
+
+void DetectorResponse::FinishEvent(CrystalDeposits& deposits) const
+{
+  G4bool smear = UseLightCollection();
+  for (std::size_t i = 0; i < deposits.light.size(); i++) {
+    G4double& photoElectrons = deposits.photoElectrons[i];
+    if (photoElectrons > 0.) photoElectrons = G4Poisson(photoElectrons);
+
+    const G4double* speciesLight = &deposits.speciesLight[i * kNumberOfSpecies];
+    G4double tail = 0., total = 0.;
+    for (G4int s = 0; s < kNumberOfSpecies; s++) {
+      tail += speciesLight[s] * fTailIntegral[s];
+      total += speciesLight[s] * fTotalIntegral[s];
+    }
+    G4double ratio = total > 0. ? tail / total : 0.;
+
+    // each photoelectron falls in the tail with that probability
+    if (smear && photoElectrons >= 1.) {
+      G4long n = static_cast<G4long>(photoElectrons);
+      ratio = static_cast<G4double>(CLHEP::RandBinomial::shoot(n, ratio)) / n;
+    }
+    deposits.tailToTotal[i] = ratio;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorResponse::PrepareLightCollection(G4bool rebuild)
+{
+  if (!fLightCollection && !rebuild) return;
+
+  if (fDetector->GetBuiltLattice()) {
+    G4cout << "\n--> warning from DetectorResponse::PrepareLightCollection : "
+           << "the light collection map needs the bar geometry, no photoelectrons for the lattice" << G4endl;
+    fMap = LightCollectionMap();
+    return;
+  }
+
+  LightCollectionMap::Geometry geometry;
+  geometry.crystalSize = fDetector->GetCrystalSize();
+  geometry.greaseThickness = fDetector->GetGreaseThickness();
+  geometry.coverThickness = fDetector->GetCoverThickness();
+  geometry.crystalsPerBar = fDetector->GetCrystalsPerBar();
+
+  std::string key = LightCollectionMap::MakeKey(geometry, fOptics, fMapBins, fMapPhotonsPerBin);
+  if (!rebuild && fMap.IsValid() && fMap.GetKey() == key) return;
+
+  std::string fileName;
+  if (!fMapCacheDir.empty()) {
+    std::ostringstream name;
+    name << fMapCacheDir << "/lce_" << std::hex << std::setw(16) << std::setfill('0')
+         << HashString(key) << ".txt";
+    fileName = name.str();
+  }
+
+  if (!rebuild && !fileName.empty() && fMap.Read(fileName, geometry, fOptics, fMapBins, fMapPhotonsPerBin)) {
+    G4cout << " Light collection map read from " << fileName << ", mean efficiency "
+           << fMap.GetMeanEfficiency() << G4endl;
+    return;
+  }
+
+  fMap.Build(geometry, fOptics, fMapBins, fMapPhotonsPerBin);
+  if (fileName.empty()) return;
+  std::error_code error;
+  std::filesystem::create_directories(fMapCacheDir.c_str(), error);
+  if (fMap.Write(fileName)) {
+    G4cout << " Light collection map written to " << fileName << G4endl;
+  } else {
+    G4cout << "\n--> warning from DetectorResponse::PrepareLightCollection : "
+           << "could not write " << fileName << G4endl;
+  }
+}
+
+
+G4double DetectorResponse::PhotoElectronMean(G4int scoringIndex, const G4ThreeVector& local, G4double light) const
+{
+  if (!UseLightCollection() || light <= 0.) return 0.;
+  G4int crystal = scoringIndex % fMap.GetNumberOfCrystals();
+  return light / MeV * fPhotonsPerMeV * fDetectionEfficiency * fMap.Efficiency(crystal, local);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,294 @@
+#include "DetectorResponseMessenger.hh"
+
+#include "DetectorResponse.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4SystemOfUnits.hh"
+#include <sstream>
+
+
+
+DetectorResponseMessenger::DetectorResponseMessenger(DetectorResponse* response)
+ : G4UImessenger(),
+   fResponse(response)
+{
+
+  // the response is shared by all threads and only changed on the master
+  G4bool broadcast = false;
+  fResponseDir = new G4UIdirectory("/response/", broadcast);
+  fResponseDir->SetGuidance("Scintillator response of the crystals");
+
+  fBirksCmd = new G4UIcommand("/response/birks", this);
+  fBirksCmd->SetGuidance("Birks/Chou constants of one species:");
+  fBirksCmd->SetGuidance("  dL/dx = (dE/dx) / (1 + kB dE/dx + C (dE/dx)^2)");
+  fBirksCmd->SetGuidance("kB in mm/MeV, C in (mm/MeV)^2.");
+  fBirksCmd->SetGuidance("electron: e+-, proton: p, d, t, alpha: alpha, He3, ion: heavier nuclei.");
+  G4UIparameter* speciesPrm = new G4UIparameter("species", 's', false);
+  speciesPrm->SetParameterCandidates("electron proton alpha ion");
+  fBirksCmd->SetParameter(speciesPrm);
+  G4UIparameter* kBPrm = new G4UIparameter("kB", 'd', false);
+  kBPrm->SetParameterRange("kB>=0.");
+  fBirksCmd->SetParameter(kBPrm);
+  G4UIparameter* cPrm = new G4UIparameter("C", 'd', true);
+  cPrm->SetDefaultValue(0.);
+  cPrm->SetParameterRange("C>=0.");
+  fBirksCmd->SetParameter(cPrm);
+  fBirksCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fQuenchingCmd = new G4UIcmdWithABool("/response/quenching", this);
+  fQuenchingCmd->SetGuidance("Apply Birks/Chou quenching; off gives light = deposited energy.");
+  fQuenchingCmd->SetParameterName("flag", false);
+  fQuenchingCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/response/print", this);
+  fPrintCmd->SetGuidance("Print the response parameters.");
+  fPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fLceDir = new G4UIdirectory("/response/lce/", broadcast);
+  fLceDir->SetGuidance("Photoelectrons from a precomputed light-collection efficiency map");
+
+  fLceEnableCmd = new G4UIcmdWithABool("/response/lce/enable", this);
+  fLceEnableCmd->SetGuidance("Convert the light of every deposit to photoelectrons with the map");
+  fLceEnableCmd->SetGuidance("of the current bar geometry; read from the cache or built at the next run.");
+  fLceEnableCmd->SetParameterName("flag", false);
+  fLceEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fLceBuildCmd = new G4UIcmdWithoutParameter("/response/lce/build", this);
+  fLceBuildCmd->SetGuidance("Build the map of the current geometry now by optical ray tracing");
+  fLceBuildCmd->SetGuidance("and write it to the cache, replacing any cached map.");
+  fLceBuildCmd->AvailableForStates(G4State_Idle);
+
+  fLceCacheDirCmd = new G4UIcmdWithAString("/response/lce/cacheDir", this);
+  fLceCacheDirCmd->SetGuidance("Directory of the cached maps, one file per geometry and optics key.");
+  fLceCacheDirCmd->SetParameterName("dir", false);
+  fLceCacheDirCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fLceBinsCmd = new G4UIcmdWithAnInteger("/response/lce/bins", this);
+  fLceBinsCmd->SetGuidance("Map bins per crystal axis.");
+  fLceBinsCmd->SetParameterName("bins", false);
+  fLceBinsCmd->SetRange("bins>0");
+  fLceBinsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fLcePhotonsCmd = new G4UIcmdWithAnInteger("/response/lce/photonsPerBin", this);
+  fLcePhotonsCmd->SetGuidance("Photons traced per map bin when building.");
+  fLcePhotonsCmd->SetParameterName("photons", false);
+  fLcePhotonsCmd->SetRange("photons>0");
+  fLcePhotonsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fCrystalIndexCmd = new G4UIcmdWithADouble("/response/lce/crystalIndex", this);
+  fCrystalIndexCmd->SetGuidance("Refractive index of the crystals.");
+  fCrystalIndexCmd->SetParameterName("n", false);
+  fCrystalIndexCmd->SetRange("n>=1.");
+  fCrystalIndexCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fGreaseIndexCmd = new G4UIcmdWithADouble("/response/lce/greaseIndex", this);
+  fGreaseIndexCmd->SetGuidance("Refractive index of the grease between crystals and at the readout.");
+  fGreaseIndexCmd->SetParameterName("n", false);
+  fGreaseIndexCmd->SetRange("n>=1.");
+  fGreaseIndexCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fCoverReflectivityCmd = new G4UIcmdWithADouble("/response/lce/coverReflectivity", this);
+  fCoverReflectivityCmd->SetGuidance("Diffuse reflectivity of the cover.");
+  fCoverReflectivityCmd->SetParameterName("reflectivity", false);
+  fCoverReflectivityCmd->SetRange("reflectivity>=0. && reflectivity<=1.");
+  fCoverReflectivityCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fAttenuationCmd = new G4UIcmdWithADoubleAndUnit("/response/lce/attenuationLength", this);
+  fAttenuationCmd->SetGuidance("Bulk attenuation length of the scintillation light in the crystals.");
+  fAttenuationCmd->SetParameterName("length", false);
+  fAttenuationCmd->SetRange("length>0.");
+  fAttenuationCmd->SetUnitCategory("Length");
+  fAttenuationCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fYieldCmd = new G4UIcmdWithADouble("/response/lce/photonsPerMeV", this);
+  fYieldCmd->SetGuidance("Scintillation photons per MeVee.");
+  fYieldCmd->SetParameterName("yield", false);
+  fYieldCmd->SetRange("yield>0.");
+  fYieldCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fDetectionEfficiencyCmd = new G4UIcmdWithADouble("/response/lce/detectionEfficiency", this);
+  fDetectionEfficiencyCmd->SetGuidance("Photon detection efficiency of the readout.");
+  fDetectionEfficiencyCmd->SetParameterName("efficiency", false);
+  fDetectionEfficiencyCmd->SetRange("efficiency>=0. && efficiency<=1.");
+  fDetectionEfficiencyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPsdDir = new G4UIdirectory("/response/psd/", broadcast);
+  fPsdDir->SetGuidance("Two-exponential pulse model for the TailToTotal PSD ratio");
+
+  fSlowFractionCmd = new G4UIcommand("/response/psd/slowFraction", this);
+  fSlowFractionCmd->SetGuidance("Fraction of the light of one species emitted in the slow component.");
+  G4UIparameter* psdSpeciesPrm = new G4UIparameter("species", 's', false);
+  psdSpeciesPrm->SetParameterCandidates("electron proton alpha ion");
+  fSlowFractionCmd->SetParameter(psdSpeciesPrm);
+  G4UIparameter* fractionPrm = new G4UIparameter("fraction", 'd', false);
+  fractionPrm->SetParameterRange("fraction>=0. && fraction<=1.");
+  fSlowFractionCmd->SetParameter(fractionPrm);
+  fSlowFractionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fDecayTimesCmd = new G4UIcommand("/response/psd/decayTimes", this);
+  fDecayTimesCmd->SetGuidance("Decay times of the fast and slow components.");
+  G4UIparameter* fastPrm = new G4UIparameter("fast", 'd', false);
+  fastPrm->SetParameterRange("fast>0.");
+  fDecayTimesCmd->SetParameter(fastPrm);
+  G4UIparameter* slowPrm = new G4UIparameter("slow", 'd', false);
+  slowPrm->SetParameterRange("slow>0.");
+  fDecayTimesCmd->SetParameter(slowPrm);
+  G4UIparameter* decayUnitPrm = new G4UIparameter("unit", 's', true);
+  decayUnitPrm->SetDefaultUnit("ns");
+  fDecayTimesCmd->SetParameter(decayUnitPrm);
+  fDecayTimesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fGateCmd = new G4UIcommand("/response/psd/gate", this);
+  fGateCmd->SetGuidance("Start of the tail gate and end of the total gate, from the pulse start.");
+  G4UIparameter* tailPrm = new G4UIparameter("tailStart", 'd', false);
+  tailPrm->SetParameterRange("tailStart>=0.");
+  fGateCmd->SetParameter(tailPrm);
+  G4UIparameter* gatePrm = new G4UIparameter("gate", 'd', false);
+  gatePrm->SetParameterRange("gate>0.");
+  fGateCmd->SetParameter(gatePrm);
+  G4UIparameter* gateUnitPrm = new G4UIparameter("unit", 's', true);
+  gateUnitPrm->SetDefaultUnit("ns");
+  fGateCmd->SetParameter(gateUnitPrm);
+  fGateCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBuilderDir = new G4UIdirectory("/response/builder/", broadcast);
+  fBuilderDir->SetGuidance("Event building for a time-structured source (/source/activity)");
+
+  fBuilderEnableCmd = new G4UIcmdWithABool("/response/builder/enable", this);
+  fBuilderEnableCmd->SetGuidance("Merge the crystal pulses of all events on the source time line into");
+  fBuilderEnableCmd->SetGuidance("integration windows and built events (builtEvents tree). Needs an");
+  fBuilderEnableCmd->SetGuidance("activity: a run without one is not event-built.");
+  fBuilderEnableCmd->SetParameterName("flag", false);
+  fBuilderEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fIntegrationTimeCmd = new G4UIcmdWithADoubleAndUnit("/response/builder/integrationTime", this);
+  fIntegrationTimeCmd->SetGuidance("Charge integration window opened by a pulse; later pulses inside it pile up.");
+  fIntegrationTimeCmd->SetParameterName("time", false);
+  fIntegrationTimeCmd->SetRange("time>0.");
+  fIntegrationTimeCmd->SetUnitCategory("Time");
+  fIntegrationTimeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fDeadTimeCmd = new G4UIcmdWithADoubleAndUnit("/response/builder/deadTime", this);
+  fDeadTimeCmd->SetGuidance("Non-paralysable dead time of a crystal from the start of its window.");
+  fDeadTimeCmd->SetParameterName("time", false);
+  fDeadTimeCmd->SetRange("time>=0.");
+  fDeadTimeCmd->SetUnitCategory("Time");
+  fDeadTimeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fCoincidenceWindowCmd = new G4UIcmdWithADoubleAndUnit("/response/builder/coincidenceWindow", this);
+  fCoincidenceWindowCmd->SetGuidance("Crystal windows starting this close to the first one form one event.");
+  fCoincidenceWindowCmd->SetParameterName("time", false);
+  fCoincidenceWindowCmd->SetRange("time>=0.");
+  fCoincidenceWindowCmd->SetUnitCategory("Time");
+  fCoincidenceWindowCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+}
+DetectorResponseMessenger::~DetectorResponseMessenger()
+{
+  delete fBirksCmd;
+  delete fQuenchingCmd;
+  delete fPrintCmd;
+  delete fLceEnableCmd;
+  delete fLceBuildCmd;
+  delete fLceCacheDirCmd;
+  delete fLceBinsCmd;
+  delete fLcePhotonsCmd;
+  delete fCrystalIndexCmd;
+  delete fGreaseIndexCmd;
+  delete fCoverReflectivityCmd;
+  delete fAttenuationCmd;
+  delete fYieldCmd;
+  delete fDetectionEfficiencyCmd;
+  delete fSlowFractionCmd;
+  delete fDecayTimesCmd;
+  delete fGateCmd;
+  delete fPsdDir;
+  delete fBuilderEnableCmd;
+  delete fIntegrationTimeCmd;
+  delete fDeadTimeCmd;
+  delete fCoincidenceWindowCmd;
+  delete fBuilderDir;
+  delete fLceDir;
+  delete fResponseDir;
+}
+
+void DetectorResponseMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
+
+  if (command == fBirksCmd) {
+    G4String species;
+    G4double kB, C;
+    std::istringstream is(newValue);
+    is >> species >> kB >> C;
+    for (G4int i = 0; i < DetectorResponse::kNumberOfSpecies; i++) {
+      auto id = static_cast<DetectorResponse::Species>(i);
+      if (species == DetectorResponse::GetSpeciesName(id)) {
+        fResponse->SetBirks(id, kB * mm / MeV, C * (mm * mm) / (MeV * MeV));
+      }
+    }
+  }else if (command == fQuenchingCmd) {
+    fResponse->SetQuenching(fQuenchingCmd->GetNewBoolValue(newValue));
+  }else if (command == fPrintCmd) {
+    fResponse->Print();
+  }else if (command == fLceEnableCmd) {
+    fResponse->SetLightCollection(fLceEnableCmd->GetNewBoolValue(newValue));
+  }else if (command == fLceBuildCmd) {
+    fResponse->PrepareLightCollection(true);
+  }else if (command == fLceCacheDirCmd) {
+    fResponse->SetMapCacheDir(newValue);
+  }else if (command == fLceBinsCmd) {
+    fResponse->SetMapBins(fLceBinsCmd->GetNewIntValue(newValue));
+  }else if (command == fLcePhotonsCmd) {
+    fResponse->SetMapPhotonsPerBin(fLcePhotonsCmd->GetNewIntValue(newValue));
+  }else if (command == fCrystalIndexCmd) {
+    fResponse->SetCrystalIndex(fCrystalIndexCmd->GetNewDoubleValue(newValue));
+  }else if (command == fGreaseIndexCmd) {
+    fResponse->SetGreaseIndex(fGreaseIndexCmd->GetNewDoubleValue(newValue));
+  }else if (command == fCoverReflectivityCmd) {
+    fResponse->SetCoverReflectivity(fCoverReflectivityCmd->GetNewDoubleValue(newValue));
+  }else if (command == fAttenuationCmd) {
+    fResponse->SetAttenuationLength(fAttenuationCmd->GetNewDoubleValue(newValue));
+  }else if (command == fYieldCmd) {
+    fResponse->SetPhotonsPerMeV(fYieldCmd->GetNewDoubleValue(newValue));
+  }else if (command == fDetectionEfficiencyCmd) {
+    fResponse->SetDetectionEfficiency(fDetectionEfficiencyCmd->GetNewDoubleValue(newValue));
+  }else if (command == fSlowFractionCmd) {
+    G4String species;
+    G4double fraction;
+    std::istringstream is(newValue);
+    is >> species >> fraction;
+    for (G4int i = 0; i < DetectorResponse::kNumberOfSpecies; i++) {
+      auto id = static_cast<DetectorResponse::Species>(i);
+      if (species == DetectorResponse::GetSpeciesName(id)) fResponse->SetSlowFraction(id, fraction);
+    }
+  }else if (command == fDecayTimesCmd) {
+    G4double fast, slow;
+    G4String unit;
+    std::istringstream is(newValue);
+    is >> fast >> slow >> unit;
+    G4double value = G4UIcommand::ValueOf(unit);
+    fResponse->SetDecayTimes(fast * value, slow * value);
+  }else if (command == fGateCmd) {
+    G4double tailStart, gate;
+    G4String unit;
+    std::istringstream is(newValue);
+    is >> tailStart >> gate >> unit;
+    G4double value = G4UIcommand::ValueOf(unit);
+    fResponse->SetGate(tailStart * value, gate * value);
+  }else if (command == fBuilderEnableCmd) {
+    fResponse->SetEventBuilding(fBuilderEnableCmd->GetNewBoolValue(newValue));
+  }else if (command == fIntegrationTimeCmd) {
+    fResponse->SetIntegrationTime(fIntegrationTimeCmd->GetNewDoubleValue(newValue));
+  }else if (command == fDeadTimeCmd) {
+    fResponse->SetDeadTime(fDeadTimeCmd->GetNewDoubleValue(newValue));
+  }else if (command == fCoincidenceWindowCmd) {
+    fResponse->SetCoincidenceWindow(fCoincidenceWindowCmd->GetNewDoubleValue(newValue));
+  }
+
+}
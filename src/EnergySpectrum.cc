@@ -0,0 +1,209 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file EnergySpectrum.cc
+/// \brief Implementation of the EnergySpectrum class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "EnergySpectrum.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool EnergySpectrum::BuildWatt(G4double a, G4double b, G4double maxEnergy, G4int points)
+{
+  if (a <= 0. || b < 0. || points < 2) return Build({}, {}, "Watt");
+  std::vector<G4double> energy(points), density(points);
+  for (G4int i = 0; i < points; i++) {
+    energy[i] = maxEnergy * i / (points - 1);
+    density[i] = std::exp(-energy[i] / a) * std::sinh(std::sqrt(b * energy[i]));
+  }
+  std::ostringstream name;
+  name << "Watt a=" << a / MeV << " MeV b=" << b * MeV << " /MeV";
+  return Build(energy, density, name.str());
+}
+
+
+G4bool EnergySpectrum::BuildMaxwellian(G4double temperature, G4double maxEnergy, G4int points)
+{
+  if (temperature <= 0. || points < 2) return Build({}, {}, "Maxwellian");
+  std::vector<G4double> energy(points), density(points);
+  for (G4int i = 0; i < points; i++) {
+    energy[i] = maxEnergy * i / (points - 1);
+    density[i] = std::sqrt(energy[i]) * std::exp(-energy[i] / temperature);
+  }
+  std::ostringstream name;
+  name << "Maxwellian T=" << temperature / MeV << " MeV";
+  return Build(energy, density, name.str());
+}
+
+
+G4bool EnergySpectrum::BuildAmBe()
+{
+  // per MeV, arbitrary normalisation, read off the ISO 8529-1 spectrum
+  static const G4double table[][2] = {
+    { 0.0, 0.34}, { 0.5, 0.46}, { 1.0, 0.50}, { 1.5, 0.48}, { 2.0, 0.50},
+    { 2.5, 0.62}, { 3.0, 0.85}, { 3.5, 0.80}, { 4.0, 0.76}, { 4.5, 0.86},
+    { 5.0, 0.88}, { 5.5, 0.74}, { 6.0, 0.56}, { 6.5, 0.50}, { 7.0, 0.46},
+    { 7.5, 0.40}, { 8.0, 0.30}, { 8.5, 0.20}, { 9.0, 0.13}, { 9.5, 0.08},
+    {10.0, 0.04}, {10.5, 0.02}, {11.0, 0.00}
+  };
+  std::vector<G4double> energy, density;
+  for (const auto& row : table) {
+    energy.push_back(row[0] * MeV);
+    density.push_back(row[1]);
+  }
+  return Build(energy, density, "AmBe");
+}
+
+
+G4bool EnergySpectrum::ReadFile(const G4String& fileName)
+{
+  std::ifstream in(fileName);
+  if (!in) {
+    G4cout << "\n--> warning from EnergySpectrum::ReadFile : cannot open " << fileName << G4endl;
+    return false;
+  }
+  std::vector<G4double> energy, density;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::size_t comment = line.find('#');
+    if (comment != std::string::npos) line.erase(comment);
+    std::istringstream is(line);
+    G4double e, f;
+    if (is >> e >> f) {
+      energy.push_back(e * MeV);
+      density.push_back(f);
+    }
+  }
+  return Build(energy, density, fileName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool EnergySpectrum::Build(const std::vector<G4double>& energy, const std::vector<G4double>& density,
+                             const G4String& name)
+{
+  std::size_t nBins = energy.size() > 1 ? energy.size() - 1 : 0;
+  G4bool valid = nBins > 0 && density.size() == energy.size();
+  for (std::size_t i = 0; valid && i < energy.size(); i++) {
+    if (density[i] < 0. || (i > 0 && energy[i] <= energy[i - 1])) valid = false;
+  }
+
+  // trapezoid areas are the bin probabilities
+  std::vector<G4double> area(nBins);
+  G4double total = 0., moment = 0.;
+  for (std::size_t i = 0; valid && i < nBins; i++) {
+    G4double width = energy[i + 1] - energy[i];
+    area[i] = 0.5 * (density[i] + density[i + 1]) * width;
+    total += area[i];
+    // first moment of the linear segment
+    moment += width * (density[i] * (2. * energy[i] + energy[i + 1])
+                     + density[i + 1] * (energy[i] + 2. * energy[i + 1])) / 6.;
+  }
+  if (!valid || total <= 0.) {
+    G4cout << "\n--> warning from EnergySpectrum::Build : " << name
+           << " is not a spectrum (needs increasing energies and non-negative densities)" << G4endl;
+    return false;
+  }
+
+  fName = name;
+  fEnergy = energy;
+  fDensity = density;
+  fMeanEnergy = moment / total;
+  BuildAliasTable(area, fProbability, fAlias);
+  return true;
+}
+
+
+void EnergySpectrum::BuildAliasTable(const std::vector<G4double>& weights,
+                                     std::vector<G4double>& probability, std::vector<G4int>& alias)
+{
+  std::size_t n = weights.size();
+  G4double total = 0.;
+  for (G4double w : weights) total += w;
+
+  // Vose: split the scaled probabilities into under- and overfull bins and
+  // top up each underfull bin from an overfull one
+  probability.assign(n, 0.);
+  alias.assign(n, 0);
+  std::vector<G4double> scaled(n);
+  std::vector<G4int> small, large;
+  for (std::size_t i = 0; i < n; i++) {
+    scaled[i] = weights[i] * n / total;
+    (scaled[i] < 1. ? small : large).push_back(static_cast<G4int>(i));
+  }
+  while (!small.empty() && !large.empty()) {
+    G4int less = small.back();
+    small.pop_back();
+    G4int more = large.back();
+    probability[less] = scaled[less];
+    alias[less] = more;
+    scaled[more] -= 1. - scaled[less];
+    if (scaled[more] < 1.) {
+      large.pop_back();
+      small.push_back(more);
+    }
+  }
+  // what is left is full up to rounding
+  for (G4int i : large) { probability[i] = 1.; alias[i] = i; }
+  for (G4int i : small) { probability[i] = 1.; alias[i] = i; }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double EnergySpectrum::Sample() const
+{
+  G4double u = G4UniformRand();
+  return Sample(u, G4UniformRand());
+}
+
+
+G4double EnergySpectrum::Sample(G4double u, G4double r) const
+{
+  std::size_t bin = SampleAlias(fProbability, fAlias, u);
+
+  // invert the linear density inside the bin
+  G4double f0 = fDensity[bin];
+  G4double f1 = fDensity[bin + 1];
+  G4double width = fEnergy[bin + 1] - fEnergy[bin];
+  G4double x = r;
+  if (std::abs(f1 - f0) > 1e-12 * (f0 + f1)) {
+    x = (std::sqrt(f0 * f0 + r * (f1 * f1 - f0 * f0)) - f0) / (f1 - f0);
+  }
+  return fEnergy[bin] + x * width;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
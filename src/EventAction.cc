@@ -55,24 +55,29 @@ EventAction::EventAction(RunAction* runAction,DetectorConstruction* det)
 
 EventAction::~EventAction(){}
 
-void EventAction::BeginOfEventAction(const G4Event*){  
+void EventAction::BeginOfEventAction(const G4Event* event){  
   Clear();
-  for (const auto& handle  : fDetector->scoringHandles) {
-      //fEdepMap[handle] = -100000000.0;
-      fEdepMap[handle] = 0.0;
-  }
+  const G4PrimaryVertex* vertex = event->GetPrimaryVertex();
+  fEmissionTime = vertex ? vertex->GetT0() : 0.;
+  fSourceWeight = vertex ? vertex->GetWeight() : 1.;
 }
 
-void EventAction::EndOfEventAction(const G4Event*){   
-  fRunAction->FillPerEvent(fEdepMap);
-  Clear();
+void EventAction::EndOfEventAction(const G4Event* event){   
+  fDetector->GetResponse()->FinishEvent(fDeposits);
+  fRunAction->FillPerEvent(fDeposits, fSourceWeight);
+  fRunAction->BuildEvents(fDeposits, event->GetEventID(), fEmissionTime);
+  fRunAction->AddTrackingCounts(fNumberOfSteps, fNumberOfLocalDeposits);
+  fRunAction->AddKilledTracks(fNumberOfKilled[kKillEnvelope], fNumberOfKilled[kKillTime],
+                              fNumberOfKilled[kKillEnergy]);
 }
 
-void EventAction::Clear() {
-  fEdepMap.clear();
+void EventAction::RecordPhaseSpace(const PhaseSpaceRecord& record) {
+  fRunAction->WritePhaseSpace(record);
 }
 
-void EventAction::AddEdep(const G4String& volName, G4double edep){
-    //if(fEdepMap[volName]  ==  -100000000.0)fEdepMap[volName] =0;
-    fEdepMap[volName] += edep; 
-  }
+void EventAction::Clear() {
+  fDeposits.Reset(fDetector->GetNumberOfScoringVolumes(), fRunAction->IsBuildingEvents());
+  fNumberOfSteps = 0;
+  fNumberOfLocalDeposits = 0;
+  for (G4long& killed : fNumberOfKilled) killed = 0;
+}
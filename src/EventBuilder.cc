@@ -0,0 +1,175 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file EventBuilder.cc
+/// \brief Implementation of the EventBuilder class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "EventBuilder.hh"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+  // std::push_heap builds a max-heap: invert it to keep the earliest on top
+  struct Later {
+    G4bool operator()(const EventBuilder::Pulse& a, const EventBuilder::Pulse& b) const {
+      return a.time > b.time;
+    }
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventBuilder::Start(const Settings& settings, G4int numberOfCrystals,
+                         std::function<void(const BuiltEvent&)> output)
+{
+  fSettings = settings;
+  fOutput = std::move(output);
+  fPending.clear();
+  fWindows.assign(numberOfCrystals, Window());
+  fOpen.clear();
+  fHits.clear();
+  fEvent.edep.assign(numberOfCrystals, 0.);
+  fEvent.light.assign(numberOfCrystals, 0.);
+  fEvent.photoElectrons.assign(numberOfCrystals, 0.);
+  fEvent.pulses.assign(numberOfCrystals, 0);
+  fCounters = Counters();
+}
+
+
+void EventBuilder::AddPulse(const Pulse& pulse)
+{
+  fPending.push_back(pulse);
+  std::push_heap(fPending.begin(), fPending.end(), Later());
+  fCounters.pulses++;
+}
+
+
+void EventBuilder::Process(G4double horizon)
+{
+  while (!fPending.empty() && fPending.front().time < horizon) {
+    std::pop_heap(fPending.begin(), fPending.end(), Later());
+    Pulse pulse = fPending.back();
+    fPending.pop_back();
+    // windows ending before this pulse close first, keeping the hits in order
+    CloseWindows(pulse.time);
+    ReadOut(pulse);
+  }
+  CloseWindows(horizon);
+  Build(horizon);
+}
+
+
+void EventBuilder::Flush()
+{
+  Process(std::numeric_limits<G4double>::max());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventBuilder::ReadOut(const Pulse& pulse)
+{
+  Window& window = fWindows[pulse.crystal];
+  if (window.open) {
+    window.edep += pulse.edep;
+    window.light += pulse.light;
+    window.photoElectrons += pulse.photoElectrons;
+    window.pulses++;
+    if (std::find(window.primaries.begin(), window.primaries.end(), pulse.primary) == window.primaries.end()) {
+      window.primaries.push_back(pulse.primary);
+    }
+    fCounters.piledUp++;
+    return;
+  }
+  if (pulse.time < window.deadUntil) {
+    fCounters.lost++;
+    return;
+  }
+  window.open = true;
+  window.start = pulse.time;
+  window.deadUntil = pulse.time + std::max(fSettings.deadTime, fSettings.integrationTime);
+  window.edep = pulse.edep;
+  window.light = pulse.light;
+  window.photoElectrons = pulse.photoElectrons;
+  window.pulses = 1;
+  window.primaries.assign(1, pulse.primary);
+  fOpen.push_back(pulse.crystal);
+}
+
+
+void EventBuilder::CloseWindows(G4double horizon)
+{
+  // windows open in time order and all have the same length, so they
+  // close in that order too and fHits stays sorted by start
+  while (!fOpen.empty()) {
+    G4int crystal = fOpen.front();
+    Window& window = fWindows[crystal];
+    if (horizon != std::numeric_limits<G4double>::max() && window.start + fSettings.integrationTime > horizon) return;
+    fHits.push_back({crystal, window.start, window.edep, window.light, window.photoElectrons,
+                     window.pulses, window.primaries});
+    window.open = false;
+    fOpen.pop_front();
+  }
+}
+
+
+void EventBuilder::Build(G4double horizon)
+{
+  // a hit starting inside the coincidence window closes at most one
+  // integration time after it
+  while (!fHits.empty()
+         && (horizon == std::numeric_limits<G4double>::max()
+             || fHits.front().start + fSettings.coincidenceWindow + fSettings.integrationTime <= horizon)) {
+    G4double start = fHits.front().start;
+    std::fill(fEvent.edep.begin(), fEvent.edep.end(), 0.);
+    std::fill(fEvent.light.begin(), fEvent.light.end(), 0.);
+    std::fill(fEvent.photoElectrons.begin(), fEvent.photoElectrons.end(), 0.);
+    std::fill(fEvent.pulses.begin(), fEvent.pulses.end(), 0);
+    std::vector<G4int> primaries;
+    while (!fHits.empty() && fHits.front().start < start + fSettings.coincidenceWindow) {
+      const Hit& hit = fHits.front();
+      fEvent.edep[hit.crystal] += hit.edep;
+      fEvent.light[hit.crystal] += hit.light;
+      fEvent.photoElectrons[hit.crystal] += hit.photoElectrons;
+      fEvent.pulses[hit.crystal] += hit.pulses;
+      for (G4int primary : hit.primaries) {
+        if (std::find(primaries.begin(), primaries.end(), primary) == primaries.end()) primaries.push_back(primary);
+      }
+      fHits.pop_front();
+    }
+    fEvent.time = start;
+    fEvent.numberOfPrimaries = static_cast<G4int>(primaries.size());
+    fCounters.builtEvents++;
+    if (fEvent.numberOfPrimaries > 1) fCounters.randomCoincidences++;
+    if (fOutput) fOutput(fEvent);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
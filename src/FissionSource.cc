@@ -0,0 +1,146 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file FissionSource.cc
+/// \brief Implementation of the FissionSource class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "FissionSource.hh"
+
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FissionSource::BuildCf252(G4double maxEnergy, G4int points)
+{
+  // P(nu) of Cf-252 prompt neutrons (Santi and Miller evaluation, rounded)
+  const std::vector<G4double> neutrons = {0.002, 0.024, 0.123, 0.271, 0.306, 0.188, 0.066, 0.017, 0.002};
+
+  // Watt parameters of the Cf-252 prompt neutron spectrum
+  const G4double a = 1.025 * MeV;
+  const G4double b = 2.926 / MeV;
+
+  // prompt gamma multiplicity: Poisson, truncated where it is below 1e-6
+  const G4double gammaMean = 8.3;
+  std::vector<G4double> gammas;
+  G4double term = std::exp(-gammaMean);
+  for (G4int n = 0; n == 0 || n < gammaMean || term > 1e-6; n++) {
+    gammas.push_back(term);
+    term *= gammaMean / (n + 1);
+  }
+
+  // prompt gamma spectrum, per MeV (Valentine's fit of the Verbinski data)
+  std::vector<G4double> energy, density;
+  const G4double minGamma = 0.085, maxGamma = 8.0;
+  const G4int gammaPoints = 2000;
+  for (G4int i = 0; i <= gammaPoints; i++) {
+    G4double e = minGamma + (maxGamma - minGamma) * i / gammaPoints;
+    G4double f;
+    if (e < 0.3)      f = 38.13 * (e - 0.085) * std::exp(1.648 * e);
+    else if (e < 1.0) f = 26.8 * std::exp(-2.3 * e);
+    else              f = 8.0 * std::exp(-1.1 * e);
+    energy.push_back(e * MeV);
+    density.push_back(f);
+  }
+
+  if (!fCentreOfMass.BuildMaxwellian(a, maxEnergy, points)) return false;
+  if (!fGammaSpectrum.Build(energy, density, "Cf-252 prompt gammas")) return false;
+  fFragmentEnergy = a * a * b / 4.;
+
+  EnergySpectrum::BuildAliasTable(neutrons, fNeutronProbability, fNeutronAlias);
+  EnergySpectrum::BuildAliasTable(gammas, fGammaProbability, fGammaAlias);
+
+  G4double total = 0.;
+  fMeanNeutrons = 0.;
+  for (std::size_t n = 0; n < neutrons.size(); n++) {
+    total += neutrons[n];
+    fMeanNeutrons += n * neutrons[n];
+  }
+  fMeanNeutrons /= total;
+  total = 0.;
+  fMeanGammas = 0.;
+  for (std::size_t n = 0; n < gammas.size(); n++) {
+    total += gammas[n];
+    fMeanGammas += n * gammas[n];
+  }
+  fMeanGammas /= total;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector FissionSource::Isotropic(G4double u, G4double v)
+{
+  G4double cosTheta = 1.0 - 2.0 * u;
+  G4double sinTheta = std::sqrt(std::max(0., 1.0 - cosTheta * cosTheta));
+  G4double phi = twopi * v;
+  return G4ThreeVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+}
+
+
+void FissionSource::Sample(Fission& fission, G4bool withGammas)
+{
+  CLHEP::HepRandomEngine* engine = G4Random::getTheEngine();
+
+  // axis and multiplicities first: they fix how many numbers the rest needs
+  fUniform.resize(4);
+  engine->flatArray(4, fUniform.data());
+  fission.axis = Isotropic(fUniform[0], fUniform[1]);
+  std::size_t nNeutrons = EnergySpectrum::SampleAlias(fNeutronProbability, fNeutronAlias, fUniform[2]);
+  std::size_t nGammas = withGammas ? EnergySpectrum::SampleAlias(fGammaProbability, fGammaAlias, fUniform[3]) : 0;
+
+  // per neutron: fragment, energy (2), direction (2); per gamma: energy (2), direction (2)
+  std::size_t count = 5 * nNeutrons + 4 * nGammas;
+  fUniform.resize(count);
+  if (count > 0) engine->flatArray(static_cast<G4int>(count), fUniform.data());
+  const G4double* u = fUniform.data();
+
+  fission.neutronDirection.resize(nNeutrons);
+  fission.neutronEnergy.resize(nNeutrons);
+  const G4double fragmentSpeed = std::sqrt(fFragmentEnergy);
+  for (std::size_t i = 0; i < nNeutrons; i++, u += 5) {
+    // velocities in units of sqrt(2 E / m), so the lab energy is v^2
+    G4ThreeVector fragment = (u[0] < 0.5 ? fragmentSpeed : -fragmentSpeed) * fission.axis;
+    G4ThreeVector velocity = std::sqrt(fCentreOfMass.Sample(u[1], u[2])) * Isotropic(u[3], u[4]) + fragment;
+    fission.neutronEnergy[i] = velocity.mag2();
+    fission.neutronDirection[i] = fission.neutronEnergy[i] > 0. ? velocity.unit() : fission.axis;
+  }
+
+  fission.gammaDirection.resize(nGammas);
+  fission.gammaEnergy.resize(nGammas);
+  for (std::size_t i = 0; i < nGammas; i++, u += 4) {
+    fission.gammaEnergy[i] = fGammaSpectrum.Sample(u[0], u[1]);
+    fission.gammaDirection[i] = Isotropic(u[2], u[3]);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,289 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file LightCollectionMap.cc
+/// \brief Implementation of the LightCollectionMap class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "LightCollectionMap.hh"
+
+#include "G4PhysicalConstants.hh"
+#include "G4Timer.hh"
+#include "CLHEP/Random/MixMaxRng.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+  // unpolarised Fresnel reflectance from index n1 into n2; 1 beyond the
+  // critical angle
+  G4double Reflectance(G4double n1, G4double n2, G4double cosIn)
+  {
+    G4double sinOut = n1 / n2 * std::sqrt(std::max(0., 1. - cosIn * cosIn));
+    if (sinOut >= 1.) return 1.;
+    G4double cosOut = std::sqrt(1. - sinOut * sinOut);
+    G4double rs = (n1 * cosIn - n2 * cosOut) / (n1 * cosIn + n2 * cosOut);
+    G4double rp = (n1 * cosOut - n2 * cosIn) / (n1 * cosOut + n2 * cosIn);
+    return 0.5 * (rs * rs + rp * rp);
+  }
+
+  G4ThreeVector IsotropicDirection(CLHEP::HepRandomEngine& engine)
+  {
+    G4double cosTheta = 2. * engine.flat() - 1.;
+    G4double sinTheta = std::sqrt(1. - cosTheta * cosTheta);
+    G4double phi = twopi * engine.flat();
+    return G4ThreeVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::string LightCollectionMap::MakeKey(const Geometry& geometry, const Optics& optics, G4int bins,
+                                        G4int photonsPerBin)
+{
+  std::ostringstream key;
+  key << std::setprecision(17)
+      << geometry.crystalSize << '|' << geometry.greaseThickness << '|' << geometry.coverThickness << '|'
+      << geometry.crystalsPerBar << '|' << optics.crystalIndex << '|' << optics.greaseIndex << '|'
+      << optics.coverReflectivity << '|' << optics.attenuationLength << '|' << bins << '|' << photonsPerBin;
+  return key.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LightCollectionMap::Build(const Geometry& geometry, const Optics& optics, G4int bins, G4int photonsPerBin)
+{
+  G4Timer timer;
+  timer.Start();
+
+  fKey = MakeKey(geometry, optics, bins, photonsPerBin);
+  fGeometry = geometry;
+  fOptics = optics;
+  fCrystals = geometry.crystalsPerBar;
+  fBins = bins;
+  fEfficiency.assign(static_cast<std::size_t>(fCrystals) * bins * bins * bins, 0.f);
+
+  // a private engine: the map depends only on its key, and the run seeds
+  // are not shifted by building it
+  CLHEP::MixMaxRng engine(12345);
+
+  G4double size = geometry.crystalSize;
+  G4double voxel = size / bins;
+  std::size_t cell = 0;
+  for (G4int crystal = 0; crystal < fCrystals; crystal++) {
+    for (G4int iz = 0; iz < bins; iz++) {
+      for (G4int iy = 0; iy < bins; iy++) {
+        for (G4int ix = 0; ix < bins; ix++) {
+          G4int detected = 0;
+          for (G4int photon = 0; photon < photonsPerBin; photon++) {
+            G4ThreeVector position(-0.5 * size + (ix + engine.flat()) * voxel,
+                                   -0.5 * size + (iy + engine.flat()) * voxel,
+                                   -0.5 * size + (iz + engine.flat()) * voxel);
+            if (TracePhoton(crystal, position, IsotropicDirection(engine), engine)) detected++;
+          }
+          fEfficiency[cell++] = static_cast<G4float>(detected) / photonsPerBin;
+        }
+      }
+    }
+  }
+
+  timer.Stop();
+  G4cout << " LightCollectionMap: " << fCrystals << " crystals x " << bins << "^3 bins x "
+         << photonsPerBin << " photons traced in " << timer.GetRealElapsed() << " s, mean efficiency "
+         << GetMeanEfficiency() << G4endl;
+}
+
+
+G4bool LightCollectionMap::TracePhoton(G4int crystal, G4ThreeVector position, G4ThreeVector direction,
+                                       CLHEP::HepRandomEngine& engine) const
+{
+  // position is in the frame of the current crystal; crossing a grease
+  // layer moves it to the frame of the neighbour. The layers are thin next
+  // to the crystals, so the lateral shift across them is neglected.
+  const G4double half = 0.5 * fGeometry.crystalSize;
+  const G4double nCrystal = fOptics.crystalIndex;
+  const G4double nGrease = fOptics.greaseIndex;
+
+  G4double freePath = -fOptics.attenuationLength * std::log(1. - engine.flat());
+
+  for (G4int reflection = 0; reflection < fMaxReflections; reflection++) {
+    // nearest face of the current crystal
+    G4int axis = -1;
+    G4double distance = kInfinity;
+    for (G4int k = 0; k < 3; k++) {
+      if (direction[k] == 0.) continue;
+      G4double t = ((direction[k] > 0. ? half : -half) - position[k]) / direction[k];
+      if (t < distance) {
+        distance = t;
+        axis = k;
+      }
+    }
+    distance = std::max(distance, 0.);
+
+    freePath -= distance;
+    if (freePath < 0.) return false;   // absorbed in the bulk
+    position += distance * direction;
+
+    G4double cosIn = std::abs(direction[axis]);
+    G4double sign = direction[axis] > 0. ? 1. : -1.;
+
+    if (axis == 1) {
+      // along the bar: a grease layer to the next crystal, or the readout
+      G4int next = crystal + static_cast<G4int>(sign);
+      G4double reflectance = Reflectance(nCrystal, nGrease, cosIn);
+      if (next < 0 || next >= fCrystals) {
+        if (engine.flat() >= reflectance) return true;
+      } else {
+        // incoherent sum over the two faces of the layer
+        G4double transmission = (1. - reflectance) / (1. + reflectance);
+        if (engine.flat() < transmission) {
+          crystal = next;
+          position[1] = -sign * half;
+          continue;
+        }
+      }
+      direction[1] = -direction[1];
+      continue;
+    }
+
+    // covered face: total internal or Fresnel reflection at the air gap,
+    // otherwise the photon reaches the reflector
+    if (engine.flat() < Reflectance(nCrystal, 1., cosIn)) {
+      direction[axis] = -direction[axis];
+      continue;
+    }
+    if (engine.flat() >= fOptics.coverReflectivity) return false;
+
+    // Lambertian from the reflector, refracted back into the crystal
+    G4double sinAir = std::sqrt(engine.flat());
+    G4double sinCrystal = sinAir / nCrystal;
+    G4double cosCrystal = std::sqrt(1. - sinCrystal * sinCrystal);
+    G4double phi = twopi * engine.flat();
+    G4ThreeVector tangent, normal;
+    tangent[(axis + 1) % 3] = 1.;
+    normal[axis] = -sign;
+    G4ThreeVector binormal = normal.cross(tangent);
+    direction = cosCrystal * normal + sinCrystal * (std::cos(phi) * tangent + std::sin(phi) * binormal);
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool LightCollectionMap::Read(const std::string& fileName, const Geometry& geometry, const Optics& optics,
+                                G4int bins, G4int photonsPerBin)
+{
+  std::ifstream file(fileName);
+  if (!file.good()) return false;
+
+  std::string key = MakeKey(geometry, optics, bins, photonsPerBin);
+
+  std::string line, fileKey;
+  std::getline(file, line);                 // comment
+  std::getline(file, fileKey);
+  if (fileKey != key) return false;
+
+  G4int crystals = 0, fileBins = 0;
+  file >> crystals >> fileBins;
+  if (crystals != geometry.crystalsPerBar || fileBins != bins) return false;
+  std::vector<G4float> values(static_cast<std::size_t>(crystals) * bins * bins * bins);
+  for (auto& value : values) file >> value;
+  if (!file) return false;
+
+  fKey = key;
+  fGeometry = geometry;
+  fOptics = optics;
+  fCrystals = crystals;
+  fBins = bins;
+  fEfficiency.swap(values);
+  return true;
+}
+
+
+G4bool LightCollectionMap::Write(const std::string& fileName) const
+{
+  std::ofstream file(fileName);
+  if (!file.good()) return false;
+
+  file << "# TexNeutSim light collection map: key, crystals bins, efficiency[crystal][iz][iy][ix]\n";
+  file << fKey << '\n' << fCrystals << ' ' << fBins << '\n';
+  file << std::setprecision(6);
+  for (std::size_t i = 0; i < fEfficiency.size(); i++) {
+    file << fEfficiency[i] << ((i + 1) % fBins == 0 ? '\n' : ' ');
+  }
+  return file.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double LightCollectionMap::GetMeanEfficiency() const
+{
+  if (fEfficiency.empty()) return 0.;
+  G4double sum = 0.;
+  for (G4float value : fEfficiency) sum += value;
+  return sum / fEfficiency.size();
+}
+
+
+G4double LightCollectionMap::Value(G4int crystal, G4int ix, G4int iy, G4int iz) const
+{
+  return fEfficiency[((static_cast<std::size_t>(crystal) * fBins + iz) * fBins + iy) * fBins + ix];
+}
+
+
+G4double LightCollectionMap::Efficiency(G4int crystal, const G4ThreeVector& local) const
+{
+  if (fEfficiency.empty() || crystal < 0 || crystal >= fCrystals) return 0.;
+
+  // continuous voxel coordinate of each axis, clamped to the outer centres
+  G4int lower[3];
+  G4double fraction[3];
+  G4double voxel = fGeometry.crystalSize / fBins;
+  for (G4int k = 0; k < 3; k++) {
+    G4double u = (local[k] + 0.5 * fGeometry.crystalSize) / voxel - 0.5;
+    u = std::min(std::max(u, 0.), fBins - 1.);
+    lower[k] = std::min(static_cast<G4int>(u), std::max(fBins - 2, 0));
+    fraction[k] = fBins > 1 ? u - lower[k] : 0.;
+  }
+
+  G4double value = 0.;
+  for (G4int corner = 0; corner < 8; corner++) {
+    G4int d[3] = {corner & 1, (corner >> 1) & 1, (corner >> 2) & 1};
+    G4double w = 1.;
+    for (G4int k = 0; k < 3; k++) w *= d[k] ? fraction[k] : 1. - fraction[k];
+    if (w == 0.) continue;
+    value += w * Value(crystal, lower[0] + d[0], lower[1] + d[1], lower[2] + d[2]);
+  }
+  return value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
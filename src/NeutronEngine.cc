@@ -0,0 +1,542 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file NeutronEngine.cc
+/// \brief Implementation of the NeutronEngine class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "NeutronEngine.hh"
+#include "NeutronEngineMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "RunAction.hh"
+#include "DetectorResponse.hh"
+#include "EventSchema.hh"
+
+#include "G4HadronicProcessStore.hh"
+#include "G4Neutron.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Proton.hh"
+#include "G4IonTable.hh"
+#include "G4EmCalculator.hh"
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4Timer.hh"
+#include "Randomize.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NeutronEngine::NeutronEngine(DetectorConstruction* detector)
+ : fDetector(detector),
+   fMinEnergy(1. * keV),
+   fMaxEnergy(20. * MeV),
+   fEnergyFloor(10. * keV)
+{
+  fMessenger = new NeutronEngineMessenger(this);
+}
+
+NeutronEngine::~NeutronEngine()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronEngine::Prepare()
+{
+  // a fake run rebuilds the geometry after /detector/update and makes sure
+  // the hadronic cross sections are initialised; no events, no output
+  G4UImanager::GetUIpointer()->ApplyCommand("/run/beamOn 0");
+
+  fBoxes.resize(fDetector->scoringPlacements.size());
+  for (std::size_t i = 0; i < fBoxes.size(); i++) {
+    G4ThreeVector halfSize = 0.5 * fDetector->scoringSizes[i];
+    fBoxes[i].min = fDetector->scoringPlacements[i] - halfSize;
+    fBoxes[i].max = fDetector->scoringPlacements[i] + halfSize;
+  }
+  BuildGrid();
+
+  const G4Material* material = fDetector->GetCrystalMaterial();
+  if (material != fTableMaterial) BuildCrossSectionTables(material);
+
+  // the response can change between runs; cheap next to the cross sections
+  BuildLightTables(material);
+}
+
+
+void NeutronEngine::BuildCrossSectionTables(const G4Material* material)
+{
+  G4Timer timer;
+  timer.Start();
+
+  G4HadronicProcessStore* store = G4HadronicProcessStore::Instance();
+  const G4ParticleDefinition* neutron = G4Neutron::Definition();
+
+  fLogMin = std::log(fMinEnergy);
+  fLogStep = (std::log(fMaxEnergy) - fLogMin) / (fNumberOfBins - 1);
+
+  const G4ElementVector* elements = material->GetElementVector();
+  const G4double* atomDensity = material->GetVecNbOfAtomsPerVolume();
+
+  fElements.assign(material->GetNumberOfElements(), ElementTable());
+  for (std::size_t i = 0; i < fElements.size(); i++) {
+    const G4Element* element = (*elements)[i];
+    ElementTable& table = fElements[i];
+    table.massRatio = element->GetN() * amu_c2 / neutron->GetPDGMass();
+    table.elastic.resize(fNumberOfBins);
+    table.inelastic.resize(fNumberOfBins);
+    for (G4int bin = 0; bin < fNumberOfBins; bin++) {
+      G4double energy = std::exp(fLogMin + bin * fLogStep);
+      table.elastic[bin] = atomDensity[i] *
+        store->GetElasticCrossSectionPerAtom(neutron, energy, element, material);
+      table.inelastic[bin] = atomDensity[i] *
+        (store->GetInelasticCrossSectionPerAtom(neutron, energy, element, material) +
+         store->GetCaptureCrossSectionPerAtom(neutron, energy, element, material));
+    }
+  }
+  fTableMaterial = material;
+
+  timer.Stop();
+  G4cout << " NeutronEngine: cross sections of " << material->GetName() << " tabulated for "
+         << fElements.size() << " elements in " << timer.GetRealElapsed() * 1000. << " ms" << G4endl;
+}
+
+
+void NeutronEngine::BuildLightTables(const G4Material* material)
+{
+  const DetectorResponse* response = fDetector->GetResponse();
+  const G4ElementVector* elements = material->GetElementVector();
+  G4EmCalculator calculator;
+
+  for (std::size_t i = 0; i < fElements.size(); i++) {
+    const G4Element* element = (*elements)[i];
+    G4int Z = G4lrint(element->GetZ());
+    G4int A = G4lrint(element->GetN());
+    const G4ParticleDefinition* recoil = (Z == 1 && A == 1) ? G4Proton::Definition()
+      : G4IonTable::GetIonTable()->GetIon(Z, A);
+
+    // cumulative light on the energy grid: the first bin by direct
+    // integration, then one midpoint step per bin
+    ElementTable& table = fElements[i];
+    DetectorResponse::Species species = DetectorResponse::GetSpecies(recoil);
+    table.recoilSpecies = species;
+    table.lightRatio.resize(fNumberOfBins);
+    G4double previous = std::exp(fLogMin);
+    G4double light = response->StoppingLight(recoil, material, previous);
+    table.lightRatio[0] = light / previous;
+    for (G4int bin = 1; bin < fNumberOfBins; bin++) {
+      G4double energy = std::exp(fLogMin + bin * fLogStep);
+      G4double dEdx = calculator.ComputeTotalDEDX(0.5 * (previous + energy), recoil, material);
+      light += (energy - previous) * response->Quench(species, dEdx);
+      table.lightRatio[bin] = light / energy;
+      previous = energy;
+    }
+  }
+}
+
+
+G4double NeutronEngine::Interpolate(const std::vector<G4double>& table, G4double energy) const
+{
+  G4double x = (std::log(energy) - fLogMin) / fLogStep;
+  if (x <= 0.) return table.front();
+  if (x >= fNumberOfBins - 1) return table.back();
+  G4int bin = static_cast<G4int>(x);
+  G4double f = x - bin;
+  return (1. - f) * table[bin] + f * table[bin + 1];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NeutronEngine::Intersect(const Box& box, const G4ThreeVector& position, const G4ThreeVector& direction,
+                                G4double& t0, G4double& t1)
+{
+  t0 = -kInfinity;
+  t1 = kInfinity;
+  for (G4int k = 0; k < 3; k++) {
+    G4double d = direction[k], o = position[k];
+    if (std::abs(d) < 1e-12) {
+      if (o < box.min[k] || o > box.max[k]) return false;
+      continue;
+    }
+    G4double ta = (box.min[k] - o) / d;
+    G4double tb = (box.max[k] - o) / d;
+    if (ta > tb) std::swap(ta, tb);
+    t0 = std::max(t0, ta);
+    t1 = std::min(t1, tb);
+    if (t0 >= t1) return false;
+  }
+  return true;
+}
+
+
+void NeutronEngine::BuildGrid()
+{
+  fCellStart.clear();
+  fCellBoxes.clear();
+  if (fBoxes.empty()) return;
+
+  // cells about one mean crystal wide, capped at a few cells per crystal
+  G4double high[3], meanSize[3] = {0., 0., 0.};
+  for (G4int k = 0; k < 3; k++) {
+    fGridMin[k] = kInfinity;
+    high[k] = -kInfinity;
+  }
+  for (const Box& box : fBoxes) {
+    for (G4int k = 0; k < 3; k++) {
+      fGridMin[k] = std::min(fGridMin[k], box.min[k]);
+      high[k] = std::max(high[k], box.max[k]);
+      meanSize[k] += (box.max[k] - box.min[k]) / fBoxes.size();
+    }
+  }
+  const G4double maxCells = 4. * fBoxes.size() + 64.;
+  for (G4int k = 0; k < 3; k++) {
+    G4double extent = std::max(high[k] - fGridMin[k], kCarTolerance);
+    fGridCells[k] = std::max(1, std::min(1024, static_cast<G4int>(extent / std::max(meanSize[k], kCarTolerance))));
+  }
+  while (static_cast<G4double>(fGridCells[0]) * fGridCells[1] * fGridCells[2] > maxCells) {
+    G4int* largest = std::max_element(fGridCells, fGridCells + 3);
+    *largest = std::max(1, *largest / 2);
+  }
+  for (G4int k = 0; k < 3; k++) {
+    fCellSize[k] = std::max(high[k] - fGridMin[k], kCarTolerance) / fGridCells[k];
+  }
+
+  // compressed cell lists: count, prefix sum, fill
+  auto cellRange = [this](const Box& box, G4int k, G4int& first, G4int& last) {
+    first = static_cast<G4int>(std::floor((box.min[k] - kCarTolerance - fGridMin[k]) / fCellSize[k]));
+    last = static_cast<G4int>(std::floor((box.max[k] + kCarTolerance - fGridMin[k]) / fCellSize[k]));
+    first = std::max(0, std::min(fGridCells[k] - 1, first));
+    last = std::max(0, std::min(fGridCells[k] - 1, last));
+  };
+  G4int nCells = fGridCells[0] * fGridCells[1] * fGridCells[2];
+  fCellStart.assign(nCells + 1, 0);
+  for (G4int pass = 0; pass < 2; pass++) {
+    std::vector<G4int> fill(fCellStart.begin(), fCellStart.end() - 1);
+    for (std::size_t i = 0; i < fBoxes.size(); i++) {
+      G4int lo[3], hi[3];
+      for (G4int k = 0; k < 3; k++) cellRange(fBoxes[i], k, lo[k], hi[k]);
+      for (G4int ix = lo[0]; ix <= hi[0]; ix++) {
+        for (G4int iy = lo[1]; iy <= hi[1]; iy++) {
+          for (G4int iz = lo[2]; iz <= hi[2]; iz++) {
+            G4int cell = (iz * fGridCells[1] + iy) * fGridCells[0] + ix;
+            if (pass == 0) fCellStart[cell + 1]++;
+            else fCellBoxes[fill[cell]++] = static_cast<G4int>(i);
+          }
+        }
+      }
+    }
+    if (pass == 0) {
+      for (G4int cell = 0; cell < nCells; cell++) fCellStart[cell + 1] += fCellStart[cell];
+      fCellBoxes.resize(fCellStart[nCells]);
+    }
+  }
+}
+
+
+G4int NeutronEngine::NextBox(const G4ThreeVector& position, const G4ThreeVector& direction,
+                             G4double& tEnter, G4double& tExit) const
+{
+  if (fCellStart.empty()) return -1;
+
+  // clip the ray to the grid, then walk its cells in order (3D DDA); the
+  // nearest entry found so far is final once it lies within the current cell
+  Box grid;
+  for (G4int k = 0; k < 3; k++) {
+    grid.min[k] = fGridMin[k];
+    grid.max[k] = fGridMin[k] + fGridCells[k] * fCellSize[k];
+  }
+  G4double tGrid0, tGrid1;
+  if (!Intersect(grid, position, direction, tGrid0, tGrid1) || tGrid1 <= 0.) return -1;
+  G4double t = std::max(tGrid0, 0.);
+
+  G4int cell[3], step[3];
+  G4double tNext[3], tDelta[3];
+  for (G4int k = 0; k < 3; k++) {
+    G4double x = position[k] + t * direction[k];
+    cell[k] = std::max(0, std::min(fGridCells[k] - 1, static_cast<G4int>(std::floor((x - fGridMin[k]) / fCellSize[k]))));
+    if (direction[k] > 0.) {
+      step[k] = 1;
+      tNext[k] = (fGridMin[k] + (cell[k] + 1) * fCellSize[k] - position[k]) / direction[k];
+      tDelta[k] = fCellSize[k] / direction[k];
+    } else if (direction[k] < 0.) {
+      step[k] = -1;
+      tNext[k] = (fGridMin[k] + cell[k] * fCellSize[k] - position[k]) / direction[k];
+      tDelta[k] = -fCellSize[k] / direction[k];
+    } else {
+      step[k] = 0;
+      tNext[k] = kInfinity;
+      tDelta[k] = kInfinity;
+    }
+  }
+
+  G4int next = -1;
+  G4double nearest = kInfinity;
+  while (true) {
+    G4int index = (cell[2] * fGridCells[1] + cell[1]) * fGridCells[0] + cell[0];
+    for (G4int j = fCellStart[index]; j < fCellStart[index + 1]; j++) {
+      G4int i = fCellBoxes[j];
+      G4double t0, t1;
+      if (!Intersect(fBoxes[i], position, direction, t0, t1) || t1 <= kCarTolerance) continue;
+      G4double entry = std::max(t0, 0.);
+      if (entry < nearest) {
+        nearest = entry;
+        next = i;
+        tEnter = entry;
+        tExit = t1;
+      }
+    }
+    G4int axis = (tNext[0] < tNext[1]) ? (tNext[0] < tNext[2] ? 0 : 2) : (tNext[1] < tNext[2] ? 1 : 2);
+    if (next >= 0 && nearest <= tNext[axis]) return next;
+    cell[axis] += step[axis];
+    if (cell[axis] < 0 || cell[axis] >= fGridCells[axis]) return next;
+    tNext[axis] += tDelta[axis];
+  }
+}
+
+
+void NeutronEngine::Transport(G4ThreeVector position, G4ThreeVector direction, G4double energy,
+                              G4double weight, CrystalDeposits& deposits) const
+{
+  const DetectorResponse* response = fDetector->GetResponse();
+
+  for (G4int collisions = 0; collisions < fMaxCollisions && energy > fEnergyFloor; ) {
+    G4double tEnter = 0., tExit = 0.;
+    G4int box = NextBox(position, direction, tEnter, tExit);
+    if (box < 0) return;   // leaves the array
+
+    G4double sigma = 0.;
+    for (const auto& element : fElements) {
+      sigma += Interpolate(element.elastic, energy) + Interpolate(element.inelastic, energy);
+    }
+    G4double distance = sigma > 0. ? -std::log(1. - G4UniformRand()) / sigma : kInfinity;
+
+    if (distance >= tExit - tEnter) {
+      // crosses this crystal without interacting: step just past its exit
+      position += (tExit + kCarTolerance) * direction;
+      continue;
+    }
+    position += (tEnter + distance) * direction;
+    collisions++;
+
+    // pick the channel in proportion to its macroscopic cross section
+    G4double r = G4UniformRand() * sigma;
+    const ElementTable* target = nullptr;
+    for (const auto& element : fElements) {
+      r -= Interpolate(element.elastic, energy);
+      if (r < 0.) { target = &element; break; }
+      r -= Interpolate(element.inelastic, energy);
+      if (r < 0.) return;   // absorbed or inelastic: history ends
+    }
+    if (!target) target = &fElements.back();
+
+    // elastic, isotropic in the centre-of-mass frame
+    G4double A = target->massRatio;
+    G4double mu = 2. * G4UniformRand() - 1.;
+    G4double denominator = A * A + 2. * A * mu + 1.;
+    G4double energyOut = energy * denominator / ((A + 1.) * (A + 1.));
+    G4double recoilEnergy = energy - energyOut;
+    G4double recoilLight = recoilEnergy * Interpolate(target->lightRatio, recoilEnergy);
+    G4double photoElectrons = 0.;
+    if (response->UseLightCollection()) {
+      G4ThreeVector local = position - 0.5 * (fBoxes[box].min + fBoxes[box].max);
+      photoElectrons = response->PhotoElectronMean(box, local, recoilLight);
+    }
+    // no time of flight in the engine: deposits are at t = 0
+    deposits.Add(box, target->recoilSpecies, recoilEnergy, recoilLight, photoElectrons, 0., weight);
+
+    G4double cosTheta = (1. + A * mu) / std::sqrt(denominator);
+    G4double sinTheta = std::sqrt(std::max(0., 1. - cosTheta * cosTheta));
+    G4double phi = twopi * G4UniformRand();
+    G4ThreeVector newDirection(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+    newDirection.rotateUz(direction);
+    direction = newDirection;
+    energy = energyOut;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronEngine::BeamOn(G4int nEvents)
+{
+  if (!fGenerator) {
+    G4cout << "\n--> warning from NeutronEngine::BeamOn : no primary generator on this thread" << G4endl;
+    return;
+  }
+  if (fGenerator->GetParticleDefinition() != G4Neutron::Definition()) {
+    G4cout << "\n--> warning from NeutronEngine::BeamOn : the engine only transports neutrons" << G4endl;
+    return;
+  }
+  Prepare();
+
+  G4Timer timer;
+  timer.Start();
+  fRunID++;
+
+  TFile* file = nullptr;
+  TTree* eventTree = nullptr;
+  TTree* primaryTree = nullptr;
+  EventSchema::EventRecord eventRecord;
+  EventSchema::PrimaryRecord primaryRecord;
+  if (fWriteEvents) {
+    auto now = std::chrono::system_clock::now();
+    auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << "simTree_" << std::put_time(std::localtime(&in_time_t), "%Y%m%d_%H%M%S")
+       << "_engine" << fRunID << ".root";
+    file = new TFile(ss.str().c_str(), "RECREATE");
+    eventTree = new TTree(EventSchema::kEventTree, "simEvents");
+    eventRecord.Reserve(static_cast<Int_t>(fBoxes.size()));
+    EventSchema::BindWriter(eventTree, eventRecord);
+    primaryTree = new TTree(EventSchema::kPrimaryTree, "primaryConditions");
+    EventSchema::BindWriter(primaryTree, primaryRecord);
+  }
+
+  fNumberOfEvents = nEvents;
+  fNumberOfHitEvents = 0;
+  fWeightedHitEvents = 0.;
+  fTotalEdep = 0.;
+
+  const DetectorResponse* response = fDetector->GetResponse();
+  CrystalDeposits deposits;
+  fGenerator->ResetBatch();
+  G4ThreeVector position, direction;
+  G4double energy, weight;
+  for (G4int event = 0; event < nEvents; event++) {
+    if (fGenerator->IsEventSeeding()) fGenerator->SeedEvent(fRunID, event);
+    fGenerator->NextPrimary(position, direction, energy, weight);
+    deposits.Reset(fBoxes.size());
+    if (weight > 0.) Transport(position, direction, energy, weight, deposits);
+
+    G4double eventEdep = 0.;
+    for (G4double value : deposits.edep) eventEdep += value;
+    if (eventEdep > 0.) {
+      fNumberOfHitEvents++;
+      fWeightedHitEvents += weight;
+    }
+    fTotalEdep += eventEdep;
+
+    if (fWriteEvents) {
+      response->FinishEvent(deposits);
+      eventRecord.Fill(deposits);
+      eventRecord.weight = weight;
+      eventTree->Fill();
+      for (G4int k = 0; k < 3; k++) {
+        primaryRecord.position[k] = position[k];
+        primaryRecord.direction[k] = direction[k];
+      }
+      primaryRecord.energy = energy;
+      primaryRecord.pdg = G4Neutron::Definition()->GetPDGEncoding();
+      primaryRecord.weight = weight;
+      primaryTree->Fill();
+    }
+  }
+
+  if (fWriteEvents) {
+    TTree* geometryTree = new TTree(EventSchema::kGeometryTree, "Detector Conditions");
+    EventSchema::GeometryRecord geometryRecord;
+    EventSchema::BindWriter(geometryTree, geometryRecord);
+    for (std::size_t i = 0; i < fBoxes.size(); i++) {
+      geometryRecord.index = static_cast<Int_t>(i);
+      EventSchema::CopyName(geometryRecord.name, fDetector->scoringHandles[i]);
+      EventSchema::CopyName(geometryRecord.material, fDetector->scoringMaterialNames[i]);
+      for (G4int k = 0; k < 3; k++) {
+        geometryRecord.location[k] = fDetector->scoringPlacements[i][k];
+        geometryRecord.size[k] = fDetector->scoringSizes[i][k];
+      }
+      geometryTree->Fill();
+    }
+    eventTree->Write();
+    primaryTree->Write();
+    geometryTree->Write();
+    file->Close();
+    delete file;
+  }
+
+  timer.Stop();
+  fRunTime = timer.GetRealElapsed();
+
+  G4cout << " ============================================ " << G4endl;
+  G4cout << " Engine run " << fRunID << ": " << nEvents << " events in " << fRunTime << " s ("
+         << (fRunTime > 0. ? nEvents / fRunTime : 0.) << " events/s)" << G4endl;
+  G4cout << " Events with a crystal deposit: " << fNumberOfHitEvents << " ("
+         << (nEvents > 0 ? 100. * fNumberOfHitEvents / nEvents : 0.) << " %)" << G4endl;
+  G4cout << " Weighted hit efficiency: " << (nEvents > 0 ? fWeightedHitEvents / nEvents : 0.) << G4endl;
+  G4cout << " Total crystal deposit: " << G4BestUnit(fTotalEdep, "Energy") << G4endl;
+  G4cout << " ============================================ " << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronEngine::CompareWithGeant4(G4int nEvents)
+{
+  // full simulation first, then the engine on the same configuration
+  G4UImanager::GetUIpointer()->ApplyCommand("/run/beamOn " + std::to_string(nEvents));
+  const RunAction* runAction = dynamic_cast<const RunAction*>(G4RunManager::GetRunManager()->GetUserRunAction());
+  if (!runAction || runAction->GetNumberOfEvents() == 0) {
+    G4cout << "\n--> warning from NeutronEngine::CompareWithGeant4 : no Geant4 run summary" << G4endl;
+    return;
+  }
+  BeamOn(nEvents);
+  if (fNumberOfEvents == 0) return;
+
+  auto efficiency = [](G4int hits, G4int events, G4double& error) {
+    G4double p = G4double(hits) / events;
+    error = std::sqrt(p * (1. - p) / events);
+    return p;
+  };
+  G4double errorG4, errorEngine;
+  G4double effG4 = efficiency(runAction->GetNumberOfHitEvents(), runAction->GetNumberOfEvents(), errorG4);
+  G4double effEngine = efficiency(fNumberOfHitEvents, fNumberOfEvents, errorEngine);
+  G4double combined = std::sqrt(errorG4 * errorG4 + errorEngine * errorEngine);
+
+  G4cout << " ============ Engine vs Geant4 ============ " << G4endl;
+  G4cout << " Geant4 run " << runAction->GetRunID() << ", engine run " << fRunID << G4endl;
+  G4cout << " Hit efficiency:  Geant4 " << effG4 << " +- " << errorG4
+         << ", engine " << effEngine << " +- " << errorEngine
+         << " (" << (combined > 0. ? (effEngine - effG4) / combined : 0.) << " sigma)" << G4endl;
+  G4cout << " Mean deposit:    Geant4 " << G4BestUnit(runAction->GetTotalEdep() / runAction->GetNumberOfEvents(), "Energy")
+         << ", engine " << G4BestUnit(fTotalEdep / fNumberOfEvents, "Energy") << G4endl;
+  G4cout << " Speed-up:        " << (fRunTime > 0. ? runAction->GetRunTime() / fRunTime : 0.) << G4endl;
+  G4cout << " ========================================== " << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
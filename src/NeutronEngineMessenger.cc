@@ -0,0 +1,70 @@
+
+#include "NeutronEngineMessenger.hh"
+
+#include "NeutronEngine.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+
+
+NeutronEngineMessenger::NeutronEngineMessenger(NeutronEngine* engine)
+ : G4UImessenger(),
+   fEngine(engine)
+{
+
+  // the engine runs on the master only
+  G4bool broadcast = false;
+  fEngineDir = new G4UIdirectory("/engine/", broadcast);
+  fEngineDir->SetGuidance("Lightweight neutron transport for design screening");
+
+  fBeamOnCmd = new G4UIcmdWithAnInteger("/engine/beamOn", this);
+  fBeamOnCmd->SetGuidance("Transport neutrons with the engine instead of Geant4.");
+  fBeamOnCmd->SetGuidance("Uses the current geometry and /source/ settings.");
+  fBeamOnCmd->SetParameterName("nEvents", false);
+  fBeamOnCmd->SetRange("nEvents>0");
+  fBeamOnCmd->AvailableForStates(G4State_Idle);
+
+  fCompareCmd = new G4UIcmdWithAnInteger("/engine/compare", this);
+  fCompareCmd->SetGuidance("Run nEvents with Geant4, then with the engine, and compare");
+  fCompareCmd->SetGuidance("hit efficiency, mean crystal deposit and run time.");
+  fCompareCmd->SetParameterName("nEvents", false);
+  fCompareCmd->SetRange("nEvents>0");
+  fCompareCmd->AvailableForStates(G4State_Idle);
+
+  fEnergyFloorCmd = new G4UIcmdWithADoubleAndUnit("/engine/energyFloor", this);
+  fEnergyFloorCmd->SetGuidance("Neutrons below this energy are no longer followed.");
+  fEnergyFloorCmd->SetParameterName("energy", false);
+  fEnergyFloorCmd->SetRange("energy>0.");
+  fEnergyFloorCmd->SetUnitCategory("Energy");
+  fEnergyFloorCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fWriteEventsCmd = new G4UIcmdWithABool("/engine/writeEvents", this);
+  fWriteEventsCmd->SetGuidance("Write the simTree output; off keeps only the run summary.");
+  fWriteEventsCmd->SetParameterName("flag", false);
+  fWriteEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+}
+NeutronEngineMessenger::~NeutronEngineMessenger()
+{
+  delete fBeamOnCmd;
+  delete fCompareCmd;
+  delete fEnergyFloorCmd;
+  delete fWriteEventsCmd;
+  delete fEngineDir;
+}
+
+void NeutronEngineMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
+
+  if (command == fBeamOnCmd) {
+    fEngine->BeamOn(fBeamOnCmd->GetNewIntValue(newValue));
+  }else if (command == fCompareCmd) {
+    fEngine->CompareWithGeant4(fCompareCmd->GetNewIntValue(newValue));
+  }else if (command == fEnergyFloorCmd) {
+    fEngine->SetEnergyFloor(fEnergyFloorCmd->GetNewDoubleValue(newValue));
+  }else if (command == fWriteEventsCmd) {
+    fEngine->SetWriteEvents(fWriteEventsCmd->GetNewBoolValue(newValue));
+  }
+
+}
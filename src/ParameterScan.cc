@@ -0,0 +1,212 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ParameterScan.cc
+/// \brief Implementation of the ParameterScan class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "ParameterScan.hh"
+#include "ScanMessenger.hh"
+#include "RunAction.hh"
+#include "NeutronEngine.hh"
+
+#include "G4UImanager.hh"
+#include "G4RunManager.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ParameterScan::ParameterScan()
+{
+  fScanMessenger = new ScanMessenger(this);
+}
+
+ParameterScan::~ParameterScan()
+{
+  delete fScanMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ParameterScan::AddParameter(const G4String& name, G4double min, G4double max, G4int nPoints, const G4String& unit)
+{
+  Parameter parameter;
+  parameter.name = name;
+  parameter.min = min;
+  parameter.max = max;
+  parameter.nPoints = nPoints;
+  parameter.unit = unit;
+  parameter.geometry = true;
+
+  if (name == "crystalSize") {
+    parameter.command = "/detector/setCrystalSize";
+  } else if (name == "greaseThickness") {
+    parameter.command = "/detector/setGreaseThickness";
+  } else if (name == "barSpacing") {
+    parameter.command = "/detector/setBarSpacing";
+  } else if (name == "coverThickness") {
+    parameter.command = "/detector/setCoverThickness";
+  } else if (name == "energy") {
+    parameter.command = "/source/energy";
+    parameter.geometry = false;
+  } else {
+    G4cout << "\n--> warning from ParameterScan::AddParameter : "
+           << name << " is not a scannable parameter" << G4endl;
+    return;
+  }
+
+  fParameters.push_back(parameter);
+}
+
+void ParameterScan::ClearParameters()
+{
+  fParameters.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<std::vector<G4double>> ParameterScan::MakeGrid() const
+{
+  // cartesian product, first parameter varying slowest
+  std::vector<std::vector<G4double>> points(1);
+  for (const auto& parameter : fParameters) {
+    std::vector<std::vector<G4double>> extended;
+    for (const auto& point : points) {
+      for (G4int k = 0; k < parameter.nPoints; k++) {
+        G4double fraction = (parameter.nPoints > 1) ? G4double(k) / (parameter.nPoints - 1) : 0.;
+        auto next = point;
+        next.push_back(parameter.min + fraction * (parameter.max - parameter.min));
+        extended.push_back(next);
+      }
+    }
+    points.swap(extended);
+  }
+  return points;
+}
+
+std::vector<std::vector<G4double>> ParameterScan::MakeLatinHypercube() const
+{
+  // each parameter range is cut into nSamples strata and every stratum is
+  // used exactly once, in an independent random order per parameter
+  std::vector<std::vector<G4double>> points(fNumberOfSamples, std::vector<G4double>(fParameters.size()));
+  std::vector<G4int> strata(fNumberOfSamples);
+
+  for (std::size_t j = 0; j < fParameters.size(); j++) {
+    std::iota(strata.begin(), strata.end(), 0);
+    for (G4int i = fNumberOfSamples - 1; i > 0; i--) {
+      G4int k = static_cast<G4int>(G4UniformRand() * (i + 1));
+      std::swap(strata[i], strata[std::min(k, i)]);
+    }
+    const Parameter& parameter = fParameters[j];
+    for (G4int i = 0; i < fNumberOfSamples; i++) {
+      G4double u = (strata[i] + G4UniformRand()) / fNumberOfSamples;
+      points[i][j] = parameter.min + u * (parameter.max - parameter.min);
+    }
+  }
+  return points;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ParameterScan::Run()
+{
+  if (fParameters.empty()) {
+    G4cout << "\n--> warning from ParameterScan::Run : no parameters, use /scan/addParameter" << G4endl;
+    return;
+  }
+
+  auto points = fLatinHypercube ? MakeLatinHypercube() : MakeGrid();
+  G4bool useEngine = fUseEngine && fEngine;
+
+  G4UImanager* uiManager = G4UImanager::GetUIpointer();
+  G4RunManager* runManager = G4RunManager::GetRunManager();
+
+  std::ofstream summary(fSummaryFile);
+  summary << "point,runID";
+  for (const auto& parameter : fParameters) summary << ',' << parameter.name << '[' << parameter.unit << ']';
+  summary << ",events,hitEvents,efficiency,meanEdep[MeV],runTime[s]\n";
+
+  G4cout << " ============================================ " << G4endl;
+  G4cout << " Parameter scan: " << points.size() << " points x " << fEventsPerPoint << " events"
+         << (useEngine ? " (NeutronEngine)" : "") << G4endl;
+  G4cout << " ============================================ " << G4endl;
+
+  for (std::size_t i = 0; i < points.size(); i++) {
+    G4bool geometryChanged = false;
+    for (std::size_t j = 0; j < fParameters.size(); j++) {
+      std::ostringstream command;
+      command << std::setprecision(10) << fParameters[j].command << ' ' << points[i][j] << ' ' << fParameters[j].unit;
+      if (uiManager->ApplyCommand(command.str()) != fCommandSucceeded) {
+        G4cout << "\n--> warning from ParameterScan::Run : " << command.str() << " failed" << G4endl;
+      }
+      geometryChanged |= fParameters[j].geometry;
+    }
+    if (geometryChanged) uiManager->ApplyCommand("/detector/update");
+
+    G4int runID, nEvents, nHitEvents;
+    G4double totalEdep, runTime;
+    if (useEngine) {
+      fEngine->BeamOn(fEventsPerPoint);
+      runID = fEngine->GetRunID();
+      nEvents = fEngine->GetNumberOfEvents();
+      nHitEvents = fEngine->GetNumberOfHitEvents();
+      totalEdep = fEngine->GetTotalEdep();
+      runTime = fEngine->GetRunTime();
+    } else {
+      uiManager->ApplyCommand("/run/beamOn " + std::to_string(fEventsPerPoint));
+
+      // merged summary of the run just finished, from the master run action
+      const RunAction* runAction = dynamic_cast<const RunAction*>(runManager->GetUserRunAction());
+      if (!runAction) continue;
+      runID = runAction->GetRunID();
+      nEvents = runAction->GetNumberOfEvents();
+      nHitEvents = runAction->GetNumberOfHitEvents();
+      totalEdep = runAction->GetTotalEdep();
+      runTime = runAction->GetRunTime();
+    }
+
+    summary << i << ',' << runID;
+    for (G4double value : points[i]) summary << ',' << std::setprecision(10) << value;
+    summary << ',' << nEvents << ',' << nHitEvents
+            << ',' << (nEvents > 0 ? G4double(nHitEvents) / nEvents : 0.)
+            << ',' << (nEvents > 0 ? totalEdep / nEvents : 0.)
+            << ',' << runTime << '\n';
+    summary.flush();
+  }
+
+  G4cout << " Scan summary written to " << fSummaryFile << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
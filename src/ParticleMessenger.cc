@@ -2,10 +2,16 @@
 #include "ParticleMessenger.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWith3VectorAndUnit.hh"
+#include "G4UIcmdWith3Vector.hh"
 #include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4SystemOfUnits.hh"
+#include <sstream>
 
 ParticleMessenger::ParticleMessenger(PrimaryGeneratorAction* primGen)
  : G4UImessenger(),
@@ -14,7 +20,8 @@ ParticleMessenger::ParticleMessenger(PrimaryGeneratorAction* primGen)
 
     ////////////////////////////////////////////////////////////////
 
-    G4bool broadcast = false;
+    // the generator lives on every worker thread, so worker copies must see these commands
+    G4bool broadcast = true;
 
     // Source directory
     fSourceDir = new G4UIdirectory("/source/", broadcast);
@@ -26,6 +33,15 @@ ParticleMessenger::ParticleMessenger(PrimaryGeneratorAction* primGen)
     fPositionDir = new G4UIdirectory("/source/position/", broadcast);
     fPositionDir->SetGuidance("Position settings.");
 
+    fPhaseSpaceDir = new G4UIdirectory("/source/phaseSpace/", broadcast);
+    fPhaseSpaceDir->SetGuidance("Replay of a phase-space file recorded with /phaseSpace/record.");
+
+    fFissionDir = new G4UIdirectory("/source/fission/", broadcast);
+    fFissionDir->SetGuidance("Correlated Cf-252 spontaneous fission source.");
+
+    fSeedingDir = new G4UIdirectory("/source/seeding/", broadcast);
+    fSeedingDir->SetGuidance("Per-event seeds, for results independent of the thread count.");
+
 
     ////////////////////////////////////////////////////////////////
 
@@ -59,6 +75,30 @@ ParticleMessenger::ParticleMessenger(PrimaryGeneratorAction* primGen)
     fSetMaxEnergyCmd->SetUnitCategory("Energy");
     fSetMaxEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+    fSpectrumCmd = new G4UIcommand("/source/spectrum", this);
+    fSpectrumCmd->SetGuidance("Sample the energy from a spectrum, or go back to /source/energy (mono).");
+    fSpectrumCmd->SetGuidance("  watt [a b]   exp(-E/a) sinh(sqrt(bE)), a in MeV, b in 1/MeV, 0 to 20 MeV");
+    fSpectrumCmd->SetGuidance("  maxwell [T]  sqrt(E) exp(-E/T), T in MeV, 0 to 20 MeV");
+    fSpectrumCmd->SetGuidance("  ambe         coarse ISO 8529-1 AmBe shape");
+    fSpectrumCmd->SetGuidance("Omitted parameters give Cf-252: a = 1.025, b = 2.926, T = 1.42.");
+    fSpectrumCmd->SetGuidance("Tables from a file: /source/spectrumFile.");
+    G4UIparameter* typePrm = new G4UIparameter("type", 's', false);
+    typePrm->SetParameterCandidates("mono watt maxwell ambe");
+    fSpectrumCmd->SetParameter(typePrm);
+    G4UIparameter* firstPrm = new G4UIparameter("p1", 'd', true);
+    firstPrm->SetDefaultValue(0.);
+    fSpectrumCmd->SetParameter(firstPrm);
+    G4UIparameter* secondPrm = new G4UIparameter("p2", 'd', true);
+    secondPrm->SetDefaultValue(0.);
+    fSpectrumCmd->SetParameter(secondPrm);
+    fSpectrumCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fSpectrumFileCmd = new G4UIcmdWithAString("/source/spectrumFile", this);
+    fSpectrumFileCmd->SetGuidance("Sample the energy from a table: energy (MeV) and density per line,");
+    fSpectrumFileCmd->SetGuidance("linear between the points. '#' starts a comment.");
+    fSpectrumFileCmd->SetParameterName("FileName", false);
+    fSpectrumFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
     // Source position commands
     fSetSourcePositionCmd = new G4UIcmdWith3VectorAndUnit("/source/position", this);
     fSetSourcePositionCmd->SetGuidance("Set the source position.");
@@ -71,6 +111,39 @@ ParticleMessenger::ParticleMessenger(PrimaryGeneratorAction* primGen)
     fSetRandomPositionCmd->SetParameterName("RandomPosition", false);
     fSetRandomPositionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+    fShapeCmd = new G4UIcmdWithAString("/source/position/shape", this);
+    fShapeCmd->SetGuidance("Emit from a region centred on /source/position, sampled without rejection:");
+    fShapeCmd->SetGuidance("  point, box (halfSize), disk (radius), cylinder (radius, halfLength),");
+    fShapeCmd->SetGuidance("  sphereSurface, sphereVolume (radius). Oriented by /source/position/axis.");
+    fShapeCmd->SetParameterName("Shape", false);
+    fShapeCmd->SetCandidates("point box disk cylinder sphereSurface sphereVolume");
+    fShapeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fShapeHalfSizeCmd = new G4UIcmdWith3VectorAndUnit("/source/position/halfSize", this);
+    fShapeHalfSizeCmd->SetGuidance("Half sizes of a box source along its local x, y, z.");
+    fShapeHalfSizeCmd->SetParameterName("HalfX", "HalfY", "HalfZ", false);
+    fShapeHalfSizeCmd->SetUnitCategory("Length");
+    fShapeHalfSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fShapeRadiusCmd = new G4UIcmdWithADoubleAndUnit("/source/position/radius", this);
+    fShapeRadiusCmd->SetGuidance("Radius of a disk, cylinder or sphere source.");
+    fShapeRadiusCmd->SetParameterName("Radius", false);
+    fShapeRadiusCmd->SetRange("Radius>=0.");
+    fShapeRadiusCmd->SetUnitCategory("Length");
+    fShapeRadiusCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fShapeHalfLengthCmd = new G4UIcmdWithADoubleAndUnit("/source/position/halfLength", this);
+    fShapeHalfLengthCmd->SetGuidance("Half length of a cylinder source along its axis.");
+    fShapeHalfLengthCmd->SetParameterName("HalfLength", false);
+    fShapeHalfLengthCmd->SetRange("HalfLength>=0.");
+    fShapeHalfLengthCmd->SetUnitCategory("Length");
+    fShapeHalfLengthCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fShapeAxisCmd = new G4UIcmdWith3Vector("/source/position/axis", this);
+    fShapeAxisCmd->SetGuidance("Local z axis of a box, disk or cylinder source (default z).");
+    fShapeAxisCmd->SetParameterName("X", "Y", "Z", false);
+    fShapeAxisCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
     fSetIsotropicDirectionCmd = new G4UIcmdWithABool("/source/direction/isotropic", this);
     fSetIsotropicDirectionCmd->SetGuidance("Set isotropic emission (true/false).");
     fSetIsotropicDirectionCmd->SetParameterName("Isotropic", false);
@@ -99,6 +172,88 @@ ParticleMessenger::ParticleMessenger(PrimaryGeneratorAction* primGen)
     fSetMaxPhiCmd->SetParameterName("MaxPhi", false);
     fSetMaxPhiCmd->SetUnitCategory("Angle");
     fSetMaxPhiCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBiasDirectionCmd = new G4UIcmdWithABool("/source/direction/biasToDetector", this);
+    fBiasDirectionCmd->SetGuidance("Only emit toward the detector's bounding sphere (true/false).");
+    fBiasDirectionCmd->SetGuidance("Each event carries the weight analog density x cone solid angle,");
+    fBiasDirectionCmd->SetGuidance("Omega/4pi for an isotropic source.");
+    fBiasDirectionCmd->SetParameterName("Bias", false);
+    fBiasDirectionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBatchSizeCmd = new G4UIcmdWithAnInteger("/source/batchSize", this);
+    fBatchSizeCmd->SetGuidance("Pre-generate primaries in blocks of this size with bulk random draws.");
+    fBatchSizeCmd->SetGuidance("1 (default) samples every primary when its event starts.");
+    fBatchSizeCmd->SetGuidance("Larger blocks are faster, but an event's primary then depends on the");
+    fBatchSizeCmd->SetGuidance("events drawn before it, so single events can no longer be reproduced.");
+    fBatchSizeCmd->SetParameterName("BatchSize", false);
+    fBatchSizeCmd->SetRange("BatchSize>0");
+    fBatchSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBenchmarkCmd = new G4UIcmdWithAnInteger("/source/benchmark", this);
+    fBenchmarkCmd->SetGuidance("Time the generator one primary at a time and batched; reports ns/primary.");
+    fBenchmarkCmd->SetParameterName("nPrimaries", true);
+    fBenchmarkCmd->SetDefaultValue(1000000);
+    fBenchmarkCmd->SetRange("nPrimaries>0");
+    fBenchmarkCmd->SetToBeBroadcasted(false);
+    fBenchmarkCmd->AvailableForStates(G4State_Idle);
+
+    fActivityCmd = new G4UIcmdWithADoubleAndUnit("/source/activity", this);
+    fActivityCmd->SetGuidance("Emit the primaries at Poisson times with this activity per thread,");
+    fActivityCmd->SetGuidance("for pile-up and dead time with /response/builder/; 0 puts all at t = 0.");
+    fActivityCmd->SetParameterName("Activity", false);
+    fActivityCmd->SetRange("Activity>=0.");
+    fActivityCmd->SetUnitCategory("Activity");
+    fActivityCmd->SetDefaultUnit("Bq");
+    fActivityCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFissionCmd = new G4UIcmdWithABool("/source/fission/enable", this);
+    fFissionCmd->SetGuidance("Emit the prompt neutrons and gammas of one Cf-252 fission per event,");
+    fFissionCmd->SetGuidance("with sampled multiplicities, from the source position at a shared time.");
+    fFissionCmd->SetGuidance("Replaces the particle, energy and direction settings; never biased.");
+    fFissionCmd->SetParameterName("Fission", false);
+    fFissionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFissionGammasCmd = new G4UIcmdWithABool("/source/fission/gammas", this);
+    fFissionGammasCmd->SetGuidance("Include the prompt fission gammas (default true).");
+    fFissionGammasCmd->SetParameterName("Gammas", false);
+    fFissionGammasCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fEventSeedingCmd = new G4UIcmdWithABool("/source/seeding/enable", this);
+    fEventSeedingCmd->SetGuidance("Reseed the engine at the start of every event from (run seed, run ID,");
+    fEventSeedingCmd->SetGuidance("event ID): the same events give the same results with any number of");
+    fEventSeedingCmd->SetGuidance("threads. Turns primary batching off; the /source/activity time line");
+    fEventSeedingCmd->SetGuidance("and the event builder stay per thread.");
+    fEventSeedingCmd->SetParameterName("EventSeeding", false);
+    fEventSeedingCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRunSeedCmd = new G4UIcmdWithAnInteger("/source/seeding/runSeed", this);
+    fRunSeedCmd->SetGuidance("Seed the per-event seeds are derived from (default 1234567).");
+    fRunSeedCmd->SetParameterName("RunSeed", false);
+    fRunSeedCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPhaseSpaceFileCmd = new G4UIcmdWithAString("/source/phaseSpace/file", this);
+    fPhaseSpaceFileCmd->SetGuidance("Take the primaries from a phase-space file, one record per event,");
+    fPhaseSpaceFileCmd->SetGuidance("instead of the other /source/ settings; none goes back to them.");
+    fPhaseSpaceFileCmd->SetGuidance("Event N replays record N / splitting; a file that runs out starts over.");
+    fPhaseSpaceFileCmd->SetParameterName("FileName", false);
+    fPhaseSpaceFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPhaseSpaceSplitCmd = new G4UIcmdWithAnInteger("/source/phaseSpace/split", this);
+    fPhaseSpaceSplitCmd->SetGuidance("Replay every record in this many events, each with 1/n of its weight.");
+    fPhaseSpaceSplitCmd->SetParameterName("Copies", false);
+    fPhaseSpaceSplitCmd->SetRange("Copies>0");
+    fPhaseSpaceSplitCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPhaseSpaceRotateCmd = new G4UIcmdWithABool("/source/phaseSpace/rotate", this);
+    fPhaseSpaceRotateCmd->SetGuidance("Turn every replayed particle by a random angle about the rotation axis");
+    fPhaseSpaceRotateCmd->SetGuidance("through the envelope centre; valid for environments symmetric about it.");
+    fPhaseSpaceRotateCmd->SetParameterName("Rotate", false);
+    fPhaseSpaceRotateCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPhaseSpaceAxisCmd = new G4UIcmdWith3Vector("/source/phaseSpace/rotationAxis", this);
+    fPhaseSpaceAxisCmd->SetGuidance("Axis of the random rotation (default z).");
+    fPhaseSpaceAxisCmd->SetParameterName("X", "Y", "Z", false);
+    fPhaseSpaceAxisCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 }
 
 ParticleMessenger::~ParticleMessenger()
@@ -106,6 +261,10 @@ ParticleMessenger::~ParticleMessenger()
     // Delete directories
     delete fSourceDir;
     delete fDirectionDir;
+    delete fPositionDir;
+    delete fPhaseSpaceDir;
+    delete fFissionDir;
+    delete fSeedingDir;
 
     // Delete commands
     delete fSetParticleCmd;
@@ -113,13 +272,32 @@ ParticleMessenger::~ParticleMessenger()
     delete fSetUniformECmd;
     delete fSetMinEnergyCmd;
     delete fSetMaxEnergyCmd;
+    delete fSpectrumCmd;
+    delete fSpectrumFileCmd;
     delete fSetSourcePositionCmd;
     delete fSetRandomPositionCmd;
+    delete fShapeCmd;
+    delete fShapeHalfSizeCmd;
+    delete fShapeRadiusCmd;
+    delete fShapeHalfLengthCmd;
+    delete fShapeAxisCmd;
     delete fSetIsotropicDirectionCmd;
     delete fSetMinThetaCmd;
     delete fSetMaxThetaCmd;
     delete fSetMinPhiCmd;
     delete fSetMaxPhiCmd;
+    delete fBiasDirectionCmd;
+    delete fBatchSizeCmd;
+    delete fBenchmarkCmd;
+    delete fActivityCmd;
+    delete fFissionCmd;
+    delete fFissionGammasCmd;
+    delete fEventSeedingCmd;
+    delete fRunSeedCmd;
+    delete fPhaseSpaceFileCmd;
+    delete fPhaseSpaceSplitCmd;
+    delete fPhaseSpaceRotateCmd;
+    delete fPhaseSpaceAxisCmd;
 }
 
 void ParticleMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
@@ -134,10 +312,36 @@ void ParticleMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
         fPrim->SetMinEnergy(fSetMinEnergyCmd->GetNewDoubleValue(newValue));
     } else if (command == fSetMaxEnergyCmd) {
         fPrim->SetMaxEnergy(fSetMaxEnergyCmd->GetNewDoubleValue(newValue));
+    } else if (command == fSpectrumCmd) {
+        G4String type;
+        G4double first = 0., second = 0.;
+        std::istringstream is(newValue);
+        is >> type >> first >> second;
+        if (type == "mono") {
+            fPrim->SetMonoenergetic();
+        } else if (type == "watt") {
+            fPrim->SetWattSpectrum((first > 0. ? first : 1.025) * MeV, (second > 0. ? second : 2.926) / MeV);
+        } else if (type == "maxwell") {
+            fPrim->SetMaxwellianSpectrum((first > 0. ? first : 1.42) * MeV);
+        } else if (type == "ambe") {
+            fPrim->SetAmBeSpectrum();
+        }
+    } else if (command == fSpectrumFileCmd) {
+        fPrim->SetSpectrumFile(newValue);
     } else if (command == fSetSourcePositionCmd) {
         fPrim->SetSourcePosition(fSetSourcePositionCmd->GetNew3VectorValue(newValue));
     } else if (command == fSetRandomPositionCmd) {
         fPrim->SetRandomPosition(fSetRandomPositionCmd->GetNewBoolValue(newValue));
+    } else if (command == fShapeCmd) {
+        fPrim->SetSourceShape(newValue);
+    } else if (command == fShapeHalfSizeCmd) {
+        fPrim->SetSourceHalfSize(fShapeHalfSizeCmd->GetNew3VectorValue(newValue));
+    } else if (command == fShapeRadiusCmd) {
+        fPrim->SetSourceRadius(fShapeRadiusCmd->GetNewDoubleValue(newValue));
+    } else if (command == fShapeHalfLengthCmd) {
+        fPrim->SetSourceHalfLength(fShapeHalfLengthCmd->GetNewDoubleValue(newValue));
+    } else if (command == fShapeAxisCmd) {
+        fPrim->SetSourceAxis(fShapeAxisCmd->GetNew3VectorValue(newValue));
     } else if (command == fSetIsotropicDirectionCmd) {
         fPrim->SetIsotropic(fSetIsotropicDirectionCmd->GetNewBoolValue(newValue));
     } else if (command == fSetMinThetaCmd) {
@@ -148,5 +352,29 @@ void ParticleMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
         fPrim->SetMinPhi(fSetMinPhiCmd->GetNewDoubleValue(newValue));
     } else if (command == fSetMaxPhiCmd) {
         fPrim->SetMaxPhi(fSetMaxPhiCmd->GetNewDoubleValue(newValue));
+    } else if (command == fBiasDirectionCmd) {
+        fPrim->SetBiasDirection(fBiasDirectionCmd->GetNewBoolValue(newValue));
+    } else if (command == fBatchSizeCmd) {
+        fPrim->SetBatchSize(fBatchSizeCmd->GetNewIntValue(newValue));
+    } else if (command == fBenchmarkCmd) {
+        fPrim->BenchmarkGenerator(fBenchmarkCmd->GetNewIntValue(newValue));
+    } else if (command == fActivityCmd) {
+        fPrim->SetActivity(fActivityCmd->GetNewDoubleValue(newValue));
+    } else if (command == fFissionCmd) {
+        fPrim->SetFission(fFissionCmd->GetNewBoolValue(newValue));
+    } else if (command == fFissionGammasCmd) {
+        fPrim->SetFissionGammas(fFissionGammasCmd->GetNewBoolValue(newValue));
+    } else if (command == fEventSeedingCmd) {
+        fPrim->SetEventSeeding(fEventSeedingCmd->GetNewBoolValue(newValue));
+    } else if (command == fRunSeedCmd) {
+        fPrim->SetRunSeed(fRunSeedCmd->GetNewIntValue(newValue));
+    } else if (command == fPhaseSpaceFileCmd) {
+        fPrim->SetPhaseSpaceFile(newValue);
+    } else if (command == fPhaseSpaceSplitCmd) {
+        fPrim->SetPhaseSpaceSplitting(fPhaseSpaceSplitCmd->GetNewIntValue(newValue));
+    } else if (command == fPhaseSpaceRotateCmd) {
+        fPrim->SetPhaseSpaceRotation(fPhaseSpaceRotateCmd->GetNewBoolValue(newValue));
+    } else if (command == fPhaseSpaceAxisCmd) {
+        fPrim->SetPhaseSpaceAxis(fPhaseSpaceAxisCmd->GetNew3VectorValue(newValue));
     }
 }
\ No newline at end of file
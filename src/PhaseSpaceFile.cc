@@ -0,0 +1,227 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file PhaseSpaceFile.cc
+/// \brief Implementation of the phase-space writer and reader
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "PhaseSpaceFile.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PHASESPACE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(PhaseSpaceRecord) == 40, "phase-space records are 40 bytes on disk");
+
+namespace
+{
+  const char kMagic[8] = {'T', 'N', 'P', 'H', 'S', 'P', '1', '\0'};
+  const std::size_t kBufferSize = 4096;        // records per write
+  const uint64_t kPrefetchWindow = 1 << 16;    // records per read-ahead, 2.5 MB
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhaseSpaceWriter::Open(const G4String& fileName, const G4ThreeVector& centre, G4double radius)
+{
+  Close();
+  fFile = std::fopen(fileName.c_str(), "wb");
+  if (!fFile) {
+    G4cout << "\n--> warning from PhaseSpaceWriter::Open : cannot write " << fileName << G4endl;
+    return false;
+  }
+  std::memcpy(fHeader.magic, kMagic, sizeof(kMagic));
+  fHeader.numberOfRecords = 0;
+  for (G4int k = 0; k < 3; k++) fHeader.centre[k] = centre[k];
+  fHeader.radius = radius;
+  std::fwrite(&fHeader, sizeof(fHeader), 1, fFile);
+  fBuffer.reserve(kBufferSize);
+  return true;
+}
+
+
+void PhaseSpaceWriter::Write(const PhaseSpaceRecord& record)
+{
+  fBuffer.push_back(record);
+  if (fBuffer.size() == kBufferSize) Flush();
+}
+
+
+void PhaseSpaceWriter::Flush()
+{
+  fHeader.numberOfRecords += std::fwrite(fBuffer.data(), sizeof(PhaseSpaceRecord), fBuffer.size(), fFile);
+  fBuffer.clear();
+}
+
+
+uint64_t PhaseSpaceWriter::Close()
+{
+  if (!fFile) return 0;
+  Flush();
+  std::fseek(fFile, 0, SEEK_SET);
+  std::fwrite(&fHeader, sizeof(fHeader), 1, fFile);
+  std::fclose(fFile);
+  fFile = nullptr;
+  return fHeader.numberOfRecords;
+}
+
+
+G4bool PhaseSpaceWriter::Merge(const std::vector<G4String>& parts, const G4String& output)
+{
+  PhaseSpaceWriter writer;
+  std::vector<PhaseSpaceRecord> block(kBufferSize);
+  G4bool opened = false;
+  for (const G4String& part : parts) {
+    std::ifstream in(part, std::ios::binary);
+    PhaseSpaceHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) continue;
+    if (!opened) {
+      opened = writer.Open(output, G4ThreeVector(header.centre[0], header.centre[1], header.centre[2]),
+                           header.radius);
+      if (!opened) return false;
+    }
+    // the writer buffers whole blocks; bypass it
+    writer.Flush();
+    uint64_t left = header.numberOfRecords;
+    while (left > 0 && in) {
+      std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(left, kBufferSize));
+      in.read(reinterpret_cast<char*>(block.data()), n * sizeof(PhaseSpaceRecord));
+      n = static_cast<std::size_t>(in.gcount()) / sizeof(PhaseSpaceRecord);
+      writer.fHeader.numberOfRecords += std::fwrite(block.data(), sizeof(PhaseSpaceRecord), n, writer.fFile);
+      left -= n;
+    }
+    in.close();
+    std::remove(part.c_str());
+  }
+  writer.Close();
+  return opened;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhaseSpaceReader::Open(const G4String& fileName)
+{
+  Close();
+  G4bool valid = false;
+#ifdef PHASESPACE_USE_MMAP
+  int descriptor = ::open(fileName.c_str(), O_RDONLY);
+  struct stat status;
+  if (descriptor >= 0 && ::fstat(descriptor, &status) == 0
+      && static_cast<std::size_t>(status.st_size) >= sizeof(PhaseSpaceHeader)) {
+    fMappingSize = static_cast<std::size_t>(status.st_size);
+    void* mapping = ::mmap(nullptr, fMappingSize, PROT_READ, MAP_SHARED, descriptor, 0);
+    if (mapping != MAP_FAILED) {
+      fMapping = mapping;
+      ::madvise(fMapping, fMappingSize, MADV_SEQUENTIAL);
+      std::memcpy(&fHeader, fMapping, sizeof(fHeader));
+      fRecords = reinterpret_cast<const PhaseSpaceRecord*>(static_cast<const char*>(fMapping) + sizeof(fHeader));
+      uint64_t available = (fMappingSize - sizeof(fHeader)) / sizeof(PhaseSpaceRecord);
+      fNumberOfRecords = std::min(fHeader.numberOfRecords, available);
+      valid = true;
+    }
+  }
+  if (descriptor >= 0) ::close(descriptor);   // the mapping stays valid
+#else
+  std::ifstream in(fileName, std::ios::binary);
+  if (in.read(reinterpret_cast<char*>(&fHeader), sizeof(fHeader))) {
+    fCopy.resize(fHeader.numberOfRecords);
+    in.read(reinterpret_cast<char*>(fCopy.data()), fCopy.size() * sizeof(PhaseSpaceRecord));
+    fCopy.resize(static_cast<std::size_t>(in.gcount()) / sizeof(PhaseSpaceRecord));
+    fRecords = fCopy.data();
+    fNumberOfRecords = fCopy.size();
+    valid = true;
+  }
+#endif
+
+  if (!valid || std::memcmp(fHeader.magic, kMagic, sizeof(kMagic)) != 0 || fNumberOfRecords == 0) {
+    G4cout << "\n--> warning from PhaseSpaceReader::Open : " << fileName
+           << " is not a phase-space file or holds no records" << G4endl;
+    Close();
+    return false;
+  }
+  fFileName = fileName;
+  fPrefetched = 0;
+  return true;
+}
+
+
+void PhaseSpaceReader::Close()
+{
+#ifdef PHASESPACE_USE_MMAP
+  if (fMapping) ::munmap(fMapping, fMappingSize);
+#endif
+  fMapping = nullptr;
+  fMappingSize = 0;
+  fCopy.clear();
+  fRecords = nullptr;
+  fNumberOfRecords = 0;
+  fFileName = "";
+}
+
+
+G4ThreeVector PhaseSpaceReader::GetCentre() const
+{
+  return G4ThreeVector(fHeader.centre[0], fHeader.centre[1], fHeader.centre[2]);
+}
+
+
+const PhaseSpaceRecord& PhaseSpaceReader::Get(uint64_t index)
+{
+  G4bool ahead = index + kPrefetchWindow / 2 >= fPrefetched && fPrefetched < fNumberOfRecords;
+  G4bool rewound = index + kPrefetchWindow < fPrefetched;
+  if (ahead || rewound) Prefetch(index);
+  return fRecords[index];
+}
+
+
+void PhaseSpaceReader::Prefetch(uint64_t index)
+{
+  // request the window ahead of index, so the next records are in memory
+  // by the time they are replayed
+  uint64_t first = index;
+  uint64_t last = std::min(index + kPrefetchWindow, fNumberOfRecords);
+  fPrefetched = last;
+#ifdef PHASESPACE_USE_MMAP
+  static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  std::size_t begin = sizeof(PhaseSpaceHeader) + first * sizeof(PhaseSpaceRecord);
+  std::size_t end = sizeof(PhaseSpaceHeader) + last * sizeof(PhaseSpaceRecord);
+  begin -= begin % page;
+  if (end > begin) ::madvise(static_cast<char*>(fMapping) + begin, end - begin, MADV_WILLNEED);
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
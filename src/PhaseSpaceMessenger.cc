@@ -0,0 +1,65 @@
+#include "PhaseSpaceMessenger.hh"
+
+#include "PhaseSpaceRecorder.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+
+
+PhaseSpaceMessenger::PhaseSpaceMessenger(PhaseSpaceRecorder* recorder)
+ : G4UImessenger(),
+   fRecorder(recorder)
+{
+
+  // the recorder is shared by all threads and only changed on the master
+  G4bool broadcast = false;
+  fPhaseSpaceDir = new G4UIdirectory("/phaseSpace/", broadcast);
+  fPhaseSpaceDir->SetGuidance("Record the particles entering an envelope around the detector");
+
+  fRecordCmd = new G4UIcmdWithABool("/phaseSpace/record", this);
+  fRecordCmd->SetGuidance("Write every particle crossing the envelope inward to <fileName>_run<N>.phsp.");
+  fRecordCmd->SetParameterName("flag", false);
+  fRecordCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fMarginCmd = new G4UIcmdWithADoubleAndUnit("/phaseSpace/margin", this);
+  fMarginCmd->SetGuidance("Envelope radius beyond the detector's bounding sphere.");
+  fMarginCmd->SetParameterName("margin", false);
+  fMarginCmd->SetRange("margin>=0.");
+  fMarginCmd->SetUnitCategory("Length");
+  fMarginCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fFileNameCmd = new G4UIcmdWithAString("/phaseSpace/fileName", this);
+  fFileNameCmd->SetGuidance("Base name of the phase-space files.");
+  fFileNameCmd->SetParameterName("name", false);
+  fFileNameCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fKillCmd = new G4UIcmdWithABool("/phaseSpace/killAtEnvelope", this);
+  fKillCmd->SetGuidance("Stop recorded particles at the envelope; the replay transports them.");
+  fKillCmd->SetParameterName("flag", false);
+  fKillCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+}
+PhaseSpaceMessenger::~PhaseSpaceMessenger()
+{
+  delete fRecordCmd;
+  delete fMarginCmd;
+  delete fFileNameCmd;
+  delete fKillCmd;
+  delete fPhaseSpaceDir;
+}
+
+void PhaseSpaceMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
+
+  if (command == fRecordCmd) {
+    fRecorder->SetRecording(fRecordCmd->GetNewBoolValue(newValue));
+  }else if (command == fMarginCmd) {
+    fRecorder->SetMargin(fMarginCmd->GetNewDoubleValue(newValue));
+  }else if (command == fFileNameCmd) {
+    fRecorder->SetFileName(newValue);
+  }else if (command == fKillCmd) {
+    fRecorder->SetKillAtEnvelope(fKillCmd->GetNewBoolValue(newValue));
+  }
+
+}
@@ -0,0 +1,137 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file PhaseSpaceRecorder.cc
+/// \brief Implementation of the PhaseSpaceRecorder class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "PhaseSpaceRecorder.hh"
+#include "PhaseSpaceMessenger.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4Step.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceRecorder::PhaseSpaceRecorder(const DetectorConstruction* detector)
+ : fDetector(detector)
+{
+  fMargin = 1. * cm;
+  fMessenger = new PhaseSpaceMessenger(this);
+}
+
+
+PhaseSpaceRecorder::~PhaseSpaceRecorder()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector PhaseSpaceRecorder::GetCentre() const
+{
+  return fDetector->GetBoundingCentre();
+}
+
+
+G4double PhaseSpaceRecorder::GetRadius() const
+{
+  G4double radius = fDetector->GetBoundingRadius();
+  return radius > 0. ? radius + fMargin : 0.;
+}
+
+
+G4String PhaseSpaceRecorder::GetFileName(G4int runID, G4int threadID) const
+{
+  std::ostringstream name;
+  name << fFileName << "_run" << runID;
+  if (threadID >= 0) name << "_t" << threadID;
+  name << ".phsp";
+  return name.str();
+}
+
+
+void PhaseSpaceRecorder::MergeThreadFiles(G4int runID, G4int numberOfThreads) const
+{
+  std::vector<G4String> parts;
+  for (G4int i = 0; i < numberOfThreads; i++) parts.push_back(GetFileName(runID, i));
+  if (!PhaseSpaceWriter::Merge(parts, GetFileName(runID))) {
+    G4cout << "\n--> warning from PhaseSpaceRecorder::MergeThreadFiles : "
+           << "no thread file of run " << runID << " could be read" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhaseSpaceRecorder::Crossing(const G4Step* step, PhaseSpaceRecord& record) const
+{
+  G4double radius = GetRadius();
+  if (radius <= 0.) return false;
+
+  const G4StepPoint* preStep = step->GetPreStepPoint();
+  const G4StepPoint* postStep = step->GetPostStepPoint();
+  G4ThreeVector centre = GetCentre();
+  G4ThreeVector start = preStep->GetPosition() - centre;
+  G4ThreeVector chord = postStep->GetPosition() - preStep->GetPosition();
+  G4double radius2 = radius * radius;
+  if (start.mag2() <= radius2 || (start + chord).mag2() > radius2) return false;
+
+  // first root of |start + f chord| = radius
+  G4double a = chord.mag2();
+  G4double b = start.dot(chord);
+  G4double c = start.mag2() - radius2;
+  G4double f = (-b - std::sqrt(std::max(0., b * b - a * c))) / a;
+
+  // a neutral particle keeps its pre-step state up to the post-step
+  // interaction; a charged one loses energy along the step
+  G4double energy = preStep->GetKineticEnergy();
+  if (step->GetTrack()->GetDefinition()->GetPDGCharge() != 0.) {
+    energy += f * (postStep->GetKineticEnergy() - energy);
+  }
+  G4double time = preStep->GetGlobalTime() + f * (postStep->GetGlobalTime() - preStep->GetGlobalTime());
+  G4ThreeVector position = preStep->GetPosition() + f * chord;
+  const G4ThreeVector& direction = preStep->GetMomentumDirection();
+
+  for (G4int k = 0; k < 3; k++) {
+    record.position[k] = static_cast<float>(position[k] / mm);
+    record.direction[k] = static_cast<float>(direction[k]);
+  }
+  record.energy = static_cast<float>(energy / MeV);
+  record.time = static_cast<float>(time / ns);
+  record.weight = static_cast<float>(preStep->GetWeight());
+  record.pdg = step->GetTrack()->GetDefinition()->GetPDGEncoding();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -25,6 +25,8 @@
 
 
 #include "PhysicsList.hh"
+#include "PhysicsMessenger.hh"
+#include "ProcessMemory.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4UnitsTable.hh"
 #include "G4HadronElasticPhysics.hh"
@@ -33,8 +35,36 @@
 #include "G4IonPhysicsXS.hh"
 #include "G4StoppingPhysics.hh"
 #include "G4EmStandardPhysics.hh"
+#include "G4EmStandardPhysics_option3.hh"
+#include "G4EmStandardPhysics_option4.hh"
+#include "G4EmLivermorePhysics.hh"
 #include "G4DecayPhysics.hh"
 #include "G4RadioactiveDecayPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
+#include "G4GenericBiasingPhysics.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4StateManager.hh"
+#include "G4Threading.hh"
+#include "G4BosonConstructor.hh"
+#include "G4LeptonConstructor.hh"
+#include "G4MesonConstructor.hh"
+#include "G4BaryonConstructor.hh"
+#include "G4IonConstructor.hh"
+#include "G4ShortLivedConstructor.hh"
+#include <chrono>
+#include <iomanip>
+
+
+namespace {
+  // Known constructors, in the order their processes are constructed
+  const std::vector<G4String> kConstructorNames = {
+    "hadronElastic", "hadronInelastic", "ionElastic", "ionInelastic",
+    "stopping", "em", "decay", "radioactiveDecay", "biasing", "fastSimulation"
+  };
+}
 
 
 PhysicsList::PhysicsList()
@@ -43,56 +73,106 @@ PhysicsList::PhysicsList()
   fHadronInelastic(nullptr),
   fIonElastic(nullptr), 
   fIonInelastic(nullptr),
+  fGammaNuclear(nullptr),
   fElectromagnetic(nullptr),
   fDecay(nullptr), 
-  fRadioactiveDecay(nullptr) 
+  fRadioactiveDecay(nullptr),
+  fStopping(nullptr),
+  fFastSimulation(nullptr),
+  fBiasing(nullptr),
+  fMessenger(nullptr)
 {
 
   G4int verb = 0;
   SetVerboseLevel(verb);
-  
 
- // Hadron Elastic scattering
-  fHadronElastic = new G4HadronElasticPhysics(verb);
-  RegisterPhysics(fHadronElastic);
+  fMessenger = new PhysicsMessenger(this);
+  fMemoryAtStart = ProcessMemory::ResidentMB();
+  fCreated = std::chrono::steady_clock::now();
 
-  // Hadron Inelastic Physics
-  fHadronInelastic = new G4HadronPhysicsQGSP_BIC_HP(verb);
-  RegisterPhysics(fHadronInelastic);
-
-  // Ion Elastic Physics
-  fIonElastic = new G4IonElasticPhysics(verb);
-  RegisterPhysics(fIonElastic);
+  // Constructors are only instantiated in ConstructProcess(), and only if
+  // enabled, so unused ones (and their HP / decay data) cost nothing.
+  // The defaults are the processes this simulation has always built.
+  for (const auto& name : kConstructorNames) fEnabled[name] = false;
+  fEnabled["hadronElastic"] = true;
+  fEnabled["em"] = true;
+}
 
-  // Ion Inelastic Physics
-  fIonInelastic = new G4IonPhysicsXS(verb);
-  RegisterPhysics(fIonInelastic);
 
-  // stopping Particles
-  RegisterPhysics( new G4StoppingPhysics(verb));
+PhysicsList::~PhysicsList()
+{
+  delete fMessenger;
+  // not registered with the base class, so owned here
+  for (auto* constructor : fActiveConstructors) delete constructor;
+}
 
-  // Gamma-Nuclear Physics
-  //fGammaNuclear = new GammaNuclearPhysics("gamma");
-  //RegisterPhysics(fGammaNuclear);
 
-  // EM physics
-  fElectromagnetic = new G4EmStandardPhysics(verb);
-  RegisterPhysics(fElectromagnetic);
+void PhysicsList::ConstructParticle()
+{
+  // all particles up front: cheap, and independent of which constructors
+  // are enabled later in PreInit
+  G4BosonConstructor().ConstructParticle();
+  G4LeptonConstructor().ConstructParticle();
+  G4MesonConstructor().ConstructParticle();
+  G4BaryonConstructor().ConstructParticle();
+  G4IonConstructor().ConstructParticle();
+  G4ShortLivedConstructor().ConstructParticle();
+}
 
-  // Decay
-  fDecay = new G4DecayPhysics(verb);
-  RegisterPhysics(fDecay);
 
-  // Radioactive decay
-  fRadioactiveDecay = new G4RadioactiveDecayPhysics(verb);
-  RegisterPhysics(fRadioactiveDecay);
-  
+void PhysicsList::SetConstructorEnabled(const G4String& name, G4bool flag)
+{
+  auto entry = fEnabled.find(name);
+  if (entry == fEnabled.end()) {
+    G4cout << "\n--> warning from PhysicsList::SetConstructorEnabled : "
+           << "unknown constructor " << name << ", command ignored" << G4endl;
+    return;
+  }
+  entry->second = flag;
+}
 
 
+G4VPhysicsConstructor* PhysicsList::CreateConstructor(const G4String& name)
+{
+  G4int verb = 0;
+  if (name == "hadronElastic")    return fHadronElastic    = new G4HadronElasticPhysics(verb);
+  if (name == "hadronInelastic")  return fHadronInelastic  = new G4HadronPhysicsQGSP_BIC_HP(verb);
+  if (name == "ionElastic")       return fIonElastic       = new G4IonElasticPhysics(verb);
+  if (name == "ionInelastic")     return fIonInelastic     = new G4IonPhysicsXS(verb);
+  if (name == "stopping")         return fStopping         = new G4StoppingPhysics(verb);
+  if (name == "em")               return fElectromagnetic  = CreateEmConstructor();
+  if (name == "decay")            return fDecay            = new G4DecayPhysics(verb);
+  if (name == "radioactiveDecay") return fRadioactiveDecay = new G4RadioactiveDecayPhysics(verb);
+  if (name == "biasing") {
+    // wraps the neutron processes built above, so it comes after them
+    auto biasing = new G4GenericBiasingPhysics();
+    biasing->Bias("neutron");
+    return fBiasing = biasing;
+  }
+  if (name == "fastSimulation") {
+    // last in the list, after all processes it has to wrap
+    auto fastSimulation = new G4FastSimulationPhysics();
+    for (const char* particle : {"proton", "deuteron", "triton", "He3", "alpha", "GenericIon"}) {
+      fastSimulation->ActivateFastSimulation(particle);
+    }
+    return fFastSimulation = fastSimulation;
+  }
+  return nullptr;
 }
 
 
-PhysicsList::~PhysicsList(){ }
+G4VPhysicsConstructor* PhysicsList::CreateEmConstructor()
+{
+  G4int verb = 0;
+  if (fEmOption == "opt3")      return new G4EmStandardPhysics_option3(verb);
+  if (fEmOption == "opt4")      return new G4EmStandardPhysics_option4(verb);
+  if (fEmOption == "livermore") return new G4EmLivermorePhysics(verb);
+  if (fEmOption != "opt0") {
+    G4cout << "\n--> warning from PhysicsList::CreateEmConstructor : "
+           << "unknown EM option " << fEmOption << ", using opt0" << G4endl;
+  }
+  return new G4EmStandardPhysics(verb);
+}
 
 
 void PhysicsList::ConstructProcess()
@@ -100,23 +180,125 @@ void PhysicsList::ConstructProcess()
   // Transportation first (mandatory)
   AddTransportation();
 
+  // the master instantiates the enabled constructors once; workers reuse them
+  if (G4Threading::IsMasterThread()) {
+    fConstructTimer.Start();
+    if (fActiveConstructors.empty()) {
+      for (const auto& name : kConstructorNames) {
+        if (fEnabled[name]) fActiveConstructors.push_back(CreateConstructor(name));
+      }
+    }
+  }
+
   // Physics constructors
-  fHadronElastic->ConstructProcess();
-  //fHadronInelastic->ConstructProcess();
-  //fIonElastic->ConstructProcess();
-  //fIonInelastic->ConstructProcess();
-  //fGammaNuclear->ConstructProcess();
-  fElectromagnetic->ConstructProcess();
-  //fDecay->ConstructProcess();
-  //fRadioactiveDecay->ConstructProcess();
+  for (auto* constructor : fActiveConstructors) constructor->ConstructProcess();
+
+  if (G4Threading::IsMasterThread()) fConstructTimer.Stop();
+}
+
+
+void PhysicsList::ListConstructors() const
+{
+  G4cout << " ============ Physics constructors ============ " << G4endl;
+  for (const auto& name : kConstructorNames) {
+    G4cout << " " << std::setw(18) << std::left << name
+           << (fEnabled.at(name) ? "enabled" : "disabled") << G4endl;
+  }
+  G4cout << " ============================================== " << G4endl;
+}
+
+
+void PhysicsList::PrintStartupReport() const
+{
+  // called at the first BeginOfRunAction: process construction and
+  // physics tables (including any HP data) are both done by then
+  G4cout << " ============ Physics startup ============ " << G4endl;
+  G4cout << " Constructors:";
+  for (const auto& name : kConstructorNames) {
+    if (fEnabled.at(name)) G4cout << " " << name;
+  }
+  G4cout << G4endl;
+  G4cout << " EM option: " << fEmOption << G4endl;
+  if (fLocalDepositThreshold > 0.) {
+    G4cout << " Local deposit of e-/gamma below " << G4BestUnit(fLocalDepositThreshold, "Energy") << G4endl;
+  }
+  if (fKillEnvelopeMargin >= 0.) {
+    G4cout << " Kill outside the detector sphere + " << G4BestUnit(fKillEnvelopeMargin, "Length") << G4endl;
+  }
+  if (fKillTime > 0.) {
+    G4cout << " Kill after " << G4BestUnit(fKillTime, "Time") << G4endl;
+  }
+  if (fNeutronEnergyFloor > 0.) {
+    G4cout << " Kill neutrons below " << G4BestUnit(fNeutronEnergyFloor, "Energy") << G4endl;
+  }
+  G4cout << " Process construction: " << fConstructTimer.GetRealElapsed() * 1000. << " ms" << G4endl;
+  std::chrono::duration<G4double> sinceCreation = std::chrono::steady_clock::now() - fCreated;
+  G4cout << " Physics list creation to first run: " << sinceCreation.count() << " s" << G4endl;
+  G4cout << " RSS: " << ProcessMemory::ResidentMB() << " MB ("
+         << ProcessMemory::ResidentMB() - fMemoryAtStart << " MB since the physics list was created)" << G4endl;
+  G4cout << " ========================================= " << G4endl;
 }
 
 
 void PhysicsList::SetCuts()
 {
-  //SetCutValue(0*mm, "proton");
-  //SetCutValue(10*km, "e-");
-  //SetCutValue(10*km, "e+");
-  //SetCutValue(10*km, "gamma");
+  // default cut for the world, then the detector regions on top of it
+  G4VUserPhysicsList::SetCuts();
+  ApplyRegionCuts();
+}
+
+
+void PhysicsList::SetRegionCut(const G4String& region, G4double cut)
+{
+  if (region == "World") {
+    SetDefaultCutValue(cut);
+    return;
+  }
+  fRegionCuts[region] = cut;
+
+  // before initialisation the regions do not exist yet: SetCuts() applies them
+  if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+    ApplyRegionCuts();
+  }
+}
+
+
+void PhysicsList::ApplyRegionCuts()
+{
+  for (const auto& [name, cut] : fRegionCuts) {
+    G4Region* region = G4RegionStore::GetInstance()->GetRegion(name, false);
+    if (!region) {
+      G4cout << "\n--> warning from PhysicsList::ApplyRegionCuts : "
+             << "region " << name << " not found, cut not applied" << G4endl;
+      continue;
+    }
+    // region cuts survive geometry rebuilds: the G4Region objects are kept.
+    // A region without cuts of its own points at the world's default cuts;
+    // setting the cut there would change the world and every other region.
+    G4ProductionCuts* cuts = region->GetProductionCuts();
+    if (!cuts || cuts == DefaultProductionCuts()) {
+      cuts = cuts ? new G4ProductionCuts(*cuts) : new G4ProductionCuts();
+      region->SetProductionCuts(cuts);
+    }
+    cuts->SetProductionCut(cut);
+  }
+}
+
+
+G4ProductionCuts* PhysicsList::DefaultProductionCuts()
+{
+  G4Region* world = G4RegionStore::GetInstance()->GetRegion("DefaultRegionForTheWorld", false);
+  return world ? world->GetProductionCuts() : G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+}
+
+
+void PhysicsList::PrintRegionCuts() const
+{
+  G4cout << " ============ Production cuts ============ " << G4endl;
+  G4cout << " World (default): " << G4BestUnit(GetDefaultCutValue(), "Length") << G4endl;
+  for (const auto& [name, cut] : fRegionCuts) {
+    G4cout << " " << name << ": " << G4BestUnit(cut, "Length") << G4endl;
+  }
+  G4cout << " ========================================= " << G4endl;
 }
 
@@ -0,0 +1,147 @@
+
+#include "PhysicsMessenger.hh"
+
+#include "PhysicsList.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include <sstream>
+
+
+
+PhysicsMessenger::PhysicsMessenger(PhysicsList* physicsList)
+ : G4UImessenger(),
+   fPhysicsList(physicsList)
+{
+
+  // the physics list is shared by all threads and only touched on the master
+  G4bool broadcast = false;
+  fPhysDir = new G4UIdirectory("/physics/", broadcast);
+  fPhysDir->SetGuidance("Physics list control");
+
+  fRegionCutCmd = new G4UIcommand("/physics/setRegionCut", this);
+  fRegionCutCmd->SetGuidance("Set the production cut (range) of one region.");
+  fRegionCutCmd->SetGuidance("Regions: World, Crystals, Grease, Cover.");
+  fRegionCutCmd->SetGuidance("World sets the default cut, used by every volume outside the other regions.");
+  G4UIparameter* regionPrm = new G4UIparameter("region", 's', false);
+  regionPrm->SetParameterCandidates("World Crystals Grease Cover");
+  fRegionCutCmd->SetParameter(regionPrm);
+  G4UIparameter* cutPrm = new G4UIparameter("cut", 'd', false);
+  cutPrm->SetParameterRange("cut>0.");
+  fRegionCutCmd->SetParameter(cutPrm);
+  G4UIparameter* unitPrm = new G4UIparameter("unit", 's', true);
+  unitPrm->SetDefaultUnit("mm");
+  fRegionCutCmd->SetParameter(unitPrm);
+  fRegionCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPrintCutsCmd = new G4UIcmdWithoutParameter("/physics/printCuts", this);
+  fPrintCutsCmd->SetGuidance("Print the production cut of every region.");
+  fPrintCutsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  G4String constructors = "hadronElastic hadronInelastic ionElastic ionInelastic stopping em decay radioactiveDecay biasing fastSimulation";
+
+  fEnableCmd = new G4UIcmdWithAString("/physics/enable", this);
+  fEnableCmd->SetGuidance("Build the processes of a physics constructor.");
+  fEnableCmd->SetGuidance("Disabled constructors are never instantiated and load no data.");
+  fEnableCmd->SetParameterName("constructor", false);
+  fEnableCmd->SetCandidates(constructors);
+  fEnableCmd->AvailableForStates(G4State_PreInit);
+
+  fDisableCmd = new G4UIcmdWithAString("/physics/disable", this);
+  fDisableCmd->SetGuidance("Do not build the processes of a physics constructor.");
+  fDisableCmd->SetParameterName("constructor", false);
+  fDisableCmd->SetCandidates(constructors);
+  fDisableCmd->AvailableForStates(G4State_PreInit);
+
+  fListCmd = new G4UIcmdWithoutParameter("/physics/list", this);
+  fListCmd->SetGuidance("List the physics constructors and whether they are enabled.");
+  fListCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEmOptionCmd = new G4UIcmdWithAString("/physics/emOption", this);
+  fEmOptionCmd->SetGuidance("Select the EM constructor: opt0, opt3, opt4 or livermore.");
+  fEmOptionCmd->SetParameterName("option", false);
+  fEmOptionCmd->SetCandidates("opt0 opt3 opt4 livermore");
+  fEmOptionCmd->AvailableForStates(G4State_PreInit);
+
+  fLocalDepositCmd = new G4UIcmdWithADoubleAndUnit("/physics/localDepositBelow", this);
+  fLocalDepositCmd->SetGuidance("Deposit e- and gamma secondaries below this energy in the volume");
+  fLocalDepositCmd->SetGuidance("where they are created instead of tracking them. 0 disables.");
+  fLocalDepositCmd->SetParameterName("energy", false);
+  fLocalDepositCmd->SetRange("energy>=0.");
+  fLocalDepositCmd->SetUnitCategory("Energy");
+  fLocalDepositCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fKillDir = new G4UIdirectory("/physics/kill/", broadcast);
+  fKillDir->SetGuidance("Kill policies for tracks that can no longer reach the crystals");
+
+  fKillEnvelopeCmd = new G4UIcmdWithADoubleAndUnit("/physics/kill/envelope", this);
+  fKillEnvelopeCmd->SetGuidance("Kill tracks moving away from the detector outside a sphere of");
+  fKillEnvelopeCmd->SetGuidance("its bounding radius plus this margin. Negative disables.");
+  fKillEnvelopeCmd->SetParameterName("margin", false);
+  fKillEnvelopeCmd->SetUnitCategory("Length");
+  fKillEnvelopeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fKillTimeCmd = new G4UIcmdWithADoubleAndUnit("/physics/kill/time", this);
+  fKillTimeCmd->SetGuidance("Kill tracks whose global time exceeds this value. 0 disables.");
+  fKillTimeCmd->SetParameterName("time", false);
+  fKillTimeCmd->SetRange("time>=0.");
+  fKillTimeCmd->SetUnitCategory("Time");
+  fKillTimeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fNeutronFloorCmd = new G4UIcmdWithADoubleAndUnit("/physics/kill/neutronEnergyBelow", this);
+  fNeutronFloorCmd->SetGuidance("Kill neutrons below this kinetic energy. 0 disables.");
+  fNeutronFloorCmd->SetGuidance("Choose it so that no recoil above the analysis threshold is possible.");
+  fNeutronFloorCmd->SetParameterName("energy", false);
+  fNeutronFloorCmd->SetRange("energy>=0.");
+  fNeutronFloorCmd->SetUnitCategory("Energy");
+  fNeutronFloorCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+}
+PhysicsMessenger::~PhysicsMessenger()
+{
+  delete fRegionCutCmd;
+  delete fPrintCutsCmd;
+  delete fEnableCmd;
+  delete fDisableCmd;
+  delete fListCmd;
+  delete fEmOptionCmd;
+  delete fLocalDepositCmd;
+  delete fKillEnvelopeCmd;
+  delete fKillTimeCmd;
+  delete fNeutronFloorCmd;
+  delete fKillDir;
+  delete fPhysDir;
+}
+
+void PhysicsMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
+
+  if (command == fRegionCutCmd) {
+    G4String region, unit;
+    G4double cut;
+    std::istringstream is(newValue);
+    is >> region >> cut >> unit;
+    fPhysicsList->SetRegionCut(region, cut * G4UIcommand::ValueOf(unit));
+  }else if (command == fPrintCutsCmd) {
+    fPhysicsList->PrintRegionCuts();
+  }else if (command == fEnableCmd) {
+    fPhysicsList->SetConstructorEnabled(newValue, true);
+  }else if (command == fDisableCmd) {
+    fPhysicsList->SetConstructorEnabled(newValue, false);
+  }else if (command == fListCmd) {
+    fPhysicsList->ListConstructors();
+  }else if (command == fEmOptionCmd) {
+    fPhysicsList->SetEmOption(newValue);
+  }else if (command == fLocalDepositCmd) {
+    fPhysicsList->SetLocalDepositThreshold(fLocalDepositCmd->GetNewDoubleValue(newValue));
+  }else if (command == fKillEnvelopeCmd) {
+    fPhysicsList->SetKillEnvelopeMargin(fKillEnvelopeCmd->GetNewDoubleValue(newValue));
+  }else if (command == fKillTimeCmd) {
+    fPhysicsList->SetKillTime(fKillTimeCmd->GetNewDoubleValue(newValue));
+  }else if (command == fNeutronFloorCmd) {
+    fPhysicsList->SetNeutronEnergyFloor(fNeutronFloorCmd->GetNewDoubleValue(newValue));
+  }
+
+}
@@ -40,6 +40,11 @@
 
 #include "G4RandomDirection.hh"
 #include "G4Event.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4Timer.hh"
 #include "G4ParticleTable.hh"
 #include "G4IonTable.hh"
 #include "G4ParticleDefinition.hh"
@@ -48,6 +53,8 @@
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
 
+#include <algorithm>
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PrimaryGeneratorAction::PrimaryGeneratorAction(DetectorConstruction* det, RunAction* run)
@@ -62,6 +69,7 @@ PrimaryGeneratorAction::PrimaryGeneratorAction(DetectorConstruction* det, RunAct
     fUniformE = false;
     fMinEnergy = 0.0;     
     fMaxEnergy = 10.0 * MeV; 
+    fSpectrumMaxEnergy = 20.0 * MeV;
     fPosition = G4ThreeVector(0., 0., 0.);
     fRandomPosition = false; 
     fIsotropic = false;      
@@ -72,6 +80,8 @@ PrimaryGeneratorAction::PrimaryGeneratorAction(DetectorConstruction* det, RunAct
 
     G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
     fParticleDef= particleTable->FindParticle("neutron");
+    fNeutronDef = fParticleDef;
+    fGammaDef = particleTable->FindParticle("gamma");
     fParticleGun->SetParticleDefinition(fParticleDef);
 
     fParticleGun->SetParticleDefinition(fParticleDef);
@@ -105,14 +115,22 @@ void PrimaryGeneratorAction::PrintSettings()
     G4cout<< " ******************* SETTINGS  ******************* "<<G4endl;
     G4cout << "Particle Name: " << fParticleDef->GetParticleName() << G4endl;
 
-    if (!fUniformE) {
+    if (fUseFission) {
+        G4cout << "Cf-252 fission: " << fFission.GetMeanNeutrons() << " neutrons";
+        if (fFissionGammas) G4cout << ", " << fFission.GetMeanGammas() << " gammas";
+        G4cout << " per fission" << G4endl;
+    } else if (fUseSpectrum) {
+        G4cout << "Energy Spectrum: " << fSpectrum.GetName() << ", mean "
+               << fSpectrum.GetMeanEnergy() / MeV << " MeV" << G4endl;
+    } else if (!fUniformE) {
         G4cout << "Energy: " << fParticleGun->GetParticleEnergy() / MeV << " MeV" << G4endl;
     } else {
         G4cout << "Energy Range: [" << fMinEnergy / MeV << " MeV, " << fMaxEnergy / MeV << " MeV]" << G4endl;
     }
 
     if (!fRandomPosition) {
-        G4cout << "Position: " << fParticleGun->GetParticlePosition() << G4endl;
+        G4cout << "Position: " << fPosition << G4endl;
+        if (!fShape.IsPoint()) G4cout << "Source Shape: " << fShape.Describe() << G4endl;
     } else {
         G4cout << "Random Position: Yes" << G4endl;
     }
@@ -126,53 +144,422 @@ void PrimaryGeneratorAction::PrintSettings()
     G4cout<< " ******************* SETTINGS  ******************* "<<G4endl;
 
 }
-void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent){
+void PrimaryGeneratorAction::SamplePrimary(G4ThreeVector& position, G4ThreeVector& direction, G4double& energy, G4double& weight){
 
-    ////////////////////////////////////////////////////////////////
-    //// define Cf252
-    //G4int Z = 98, A = 252;
-    //G4double ionCharge   = 0.*eplus;
-    //G4double excitEnergy = 0.*keV;
-    //fParticleDef = G4IonTable::GetIonTable()->GetIon(Z,A,excitEnergy);
-    //if (!fParticleDef) {
-    //     G4cerr << "Error: Particle definition not found for Z=" << Z << ", A=" << A << G4endl;
-    //     return; 
-    //}
-    //fParticleGun->SetParticleDefinition(fParticleDef);
-    //fParticleGun->SetParticleCharge(ionCharge);
+    weight = 1.0;
 
     //////////////////////////////////////////////////////////////
     // define energy
-    if (fUniformE) {
-        fParticleGun->SetParticleEnergy(fMinEnergy + G4UniformRand() * (fMaxEnergy - fMinEnergy));
+    if (fUseSpectrum) {
+        energy = fSpectrum.Sample();
+    } else if (fUniformE) {
+        energy = fMinEnergy + G4UniformRand() * (fMaxEnergy - fMinEnergy);
     } else {
-        fParticleGun->SetParticleEnergy(fEnergy); 
+        energy = fEnergy;
     }
 
     //////////////////////////////////////////////////////////////
     // Set position based on random position settings
-    if (fRandomPosition) {
+    position = SamplePosition();
+    //////////////////////////////////////////////////////////////
+    // Set momentum direction based on isotropic settings
+    if (fBiasDirection && SampleBiasedDirection(position, direction, weight)) {
+        return;
+    }
+    direction = SampleDirection();
+}
+
+G4ThreeVector PrimaryGeneratorAction::SamplePosition() const{
 
+    if (fRandomPosition) {
       G4double world_size = fDetector->GetWorldSize();
       G4double posX = (G4UniformRand() - 0.5) * world_size/2.0;
       G4double posY = (G4UniformRand() - 0.5) * world_size/2.0;
       G4double posZ = (G4UniformRand() - 0.5) * world_size/2.0;
-      fParticleGun->SetParticlePosition(G4ThreeVector(posX, posY, posZ));
-    } else {
-        fParticleGun->SetParticlePosition(fPosition);
+      return G4ThreeVector(posX, posY, posZ);
     }
-    //////////////////////////////////////////////////////////////
-    // Set momentum direction based on isotropic settings
+    if (fShape.IsPoint()) return fPosition;
+    G4double u = G4UniformRand();
+    G4double v = G4UniformRand();
+    return fShape.Sample(fPosition, u, v, G4UniformRand());
+}
+
+G4ThreeVector PrimaryGeneratorAction::SampleDirection() const{
+
+    G4ThreeVector direction;
     if (fIsotropic) {
-        fParticleGun->SetParticleMomentumDirection(G4RandomDirection()); 
+        direction = G4RandomDirection();
     } else {
         G4double theta = fMinTheta + G4UniformRand() * (fMaxTheta - fMinTheta);
         G4double phi = fMinPhi + G4UniformRand() * (fMaxPhi - fMinPhi);
-        G4ThreeVector direction;
         direction.setRThetaPhi(1.0, theta , phi); 
-        fParticleGun->SetParticleMomentumDirection(direction);
+    }
+    return direction;
+}
+
+void PrimaryGeneratorAction::NextPrimary(G4ThreeVector& position, G4ThreeVector& direction, G4double& energy, G4double& weight){
+
+    if (fBatchSize <= 1 || fEventSeeding) {
+        SamplePrimary(position, direction, energy, weight);
+        return;
+    }
+    if (fBatch.next == fBatch.size) FillBatch();
+
+    std::size_t i = fBatch.next++;
+    position.set(fBatch.x[i], fBatch.y[i], fBatch.z[i]);
+    direction.set(fBatch.dx[i], fBatch.dy[i], fBatch.dz[i]);
+    energy = fBatch.energy[i];
+    weight = fBatch.weight[i];
+}
+
+void PrimaryGeneratorAction::FillBatch(){
+
+    // same sampling as SamplePrimary, one component at a time over the
+    // whole block: the random numbers come from one flatArray() call per
+    // component and the loops carry no branches, so they vectorise
+    std::size_t n = fBatchSize;
+    PrimaryBatch& batch = fBatch;
+    for (std::vector<G4double>* column : {&batch.x, &batch.y, &batch.z, &batch.dx, &batch.dy, &batch.dz,
+                                          &batch.energy, &batch.weight}) {
+        column->resize(n);
+    }
+    fUniform.resize(2 * n);
+    G4double* u = fUniform.data();
+    G4double* v = u + n;
+    CLHEP::HepRandomEngine* engine = G4Random::getTheEngine();
+
+    //////////////////////////////////////////////////////////////
+    // energy
+    if (fUseSpectrum) {
+        engine->flatArray(2 * n, u);
+        for (std::size_t i = 0; i < n; i++) batch.energy[i] = fSpectrum.Sample(u[i], v[i]);
+    } else if (fUniformE) {
+        engine->flatArray(n, u);
+        G4double range = fMaxEnergy - fMinEnergy;
+        for (std::size_t i = 0; i < n; i++) batch.energy[i] = fMinEnergy + u[i] * range;
+    } else {
+        std::fill(batch.energy.begin(), batch.energy.end(), fEnergy);
+    }
+
+    //////////////////////////////////////////////////////////////
+    // position
+    G4double* coordinates[3] = {batch.x.data(), batch.y.data(), batch.z.data()};
+    if (fRandomPosition) {
+        G4double halfRange = fDetector->GetWorldSize() / 2.0;
+        for (G4double* column : coordinates) {
+            engine->flatArray(n, column);
+            for (std::size_t i = 0; i < n; i++) column[i] = (column[i] - 0.5) * halfRange;
+        }
+    } else if (!fShape.IsPoint()) {
+        // three uniform columns, turned into positions in place
+        for (G4double* column : coordinates) engine->flatArray(n, column);
+        for (std::size_t i = 0; i < n; i++) {
+            G4ThreeVector position = fShape.Sample(fPosition, batch.x[i], batch.y[i], batch.z[i]);
+            batch.x[i] = position.x();
+            batch.y[i] = position.y();
+            batch.z[i] = position.z();
+        }
+    } else {
+        for (G4int k = 0; k < 3; k++) std::fill(coordinates[k], coordinates[k] + n, fPosition[k]);
+    }
+
+    //////////////////////////////////////////////////////////////
+    // direction
+    std::fill(batch.weight.begin(), batch.weight.end(), 1.0);
+    if (fBiasDirection) {
+        // the cone depends on the position of each primary: scalar
+        for (std::size_t i = 0; i < n; i++) {
+            G4ThreeVector position(batch.x[i], batch.y[i], batch.z[i]);
+            G4ThreeVector direction;
+            if (!SampleBiasedDirection(position, direction, batch.weight[i])) direction = SampleDirection();
+            batch.dx[i] = direction.x();
+            batch.dy[i] = direction.y();
+            batch.dz[i] = direction.z();
+        }
+    } else {
+        engine->flatArray(2 * n, u);
+        if (fIsotropic) {
+            for (std::size_t i = 0; i < n; i++) {
+                G4double cosTheta = 1.0 - 2.0 * u[i];
+                G4double sinTheta = std::sqrt(std::max(0., 1.0 - cosTheta * cosTheta));
+                G4double phi = twopi * v[i];
+                batch.dx[i] = sinTheta * std::cos(phi);
+                batch.dy[i] = sinTheta * std::sin(phi);
+                batch.dz[i] = cosTheta;
+            }
+        } else {
+            G4double deltaTheta = fMaxTheta - fMinTheta;
+            G4double deltaPhi = fMaxPhi - fMinPhi;
+            for (std::size_t i = 0; i < n; i++) {
+                G4double theta = fMinTheta + u[i] * deltaTheta;
+                G4double phi = fMinPhi + v[i] * deltaPhi;
+                G4double sinTheta = std::sin(theta);
+                batch.dx[i] = sinTheta * std::cos(phi);
+                batch.dy[i] = sinTheta * std::sin(phi);
+                batch.dz[i] = std::cos(theta);
+            }
+        }
     }
 
+    batch.next = 0;
+    batch.size = n;
+}
+
+void PrimaryGeneratorAction::BenchmarkGenerator(G4int nPrimaries){
+
+    G4ThreeVector position, direction;
+    G4double energy, weight;
+    G4double checksum = 0.;   // keeps the loops from being optimised away
+    G4Timer timer;
+
+    timer.Start();
+    for (G4int i = 0; i < nPrimaries; i++) {
+        SamplePrimary(position, direction, energy, weight);
+        checksum += energy + direction.z() + position.x();
+    }
+    timer.Stop();
+    G4double singleTime = timer.GetRealElapsed();
+
+    ResetBatch();
+    timer.Start();
+    for (G4int i = 0; i < nPrimaries; i++) {
+        NextPrimary(position, direction, energy, weight);
+        checksum += energy + direction.z() + position.x();
+    }
+    timer.Stop();
+    G4double batchTime = timer.GetRealElapsed();
+    ResetBatch();
+
+    G4cout << " ============================================ " << G4endl;
+    G4cout << " Primary generator benchmark" << G4endl;
+    G4cout << " Primaries: " << nPrimaries << ", batch size: " << fBatchSize << G4endl;
+    G4cout << " One at a time: " << singleTime / nPrimaries * 1.e9 << " ns/primary" << G4endl;
+    G4cout << " Batched:       " << batchTime / nPrimaries * 1.e9 << " ns/primary" << G4endl;
+    G4cout << " Checksum: " << checksum << G4endl;
+    G4cout << " ============================================ " << G4endl;
+}
+
+void PrimaryGeneratorAction::SetWattSpectrum(G4double a, G4double b){
+
+    if (fSpectrum.BuildWatt(a, b, fSpectrumMaxEnergy, fSpectrumPoints)) fUseSpectrum = true;
+}
+
+void PrimaryGeneratorAction::SetMaxwellianSpectrum(G4double temperature){
+
+    if (fSpectrum.BuildMaxwellian(temperature, fSpectrumMaxEnergy, fSpectrumPoints)) fUseSpectrum = true;
+}
+
+void PrimaryGeneratorAction::SetAmBeSpectrum(){
+
+    if (fSpectrum.BuildAmBe()) fUseSpectrum = true;
+}
+
+void PrimaryGeneratorAction::SetSpectrumFile(const G4String& fileName){
+
+    if (fSpectrum.ReadFile(fileName)) fUseSpectrum = true;
+}
+
+void PrimaryGeneratorAction::SetFission(G4bool flag){
+
+    if (flag && !fFission.IsValid() && !fFission.BuildCf252(fSpectrumMaxEnergy, fSpectrumPoints)) {
+        G4cout << "\n--> warning from PrimaryGeneratorAction::SetFission : "
+               << "the Cf-252 tables did not build, fission mode stays off" << G4endl;
+        return;
+    }
+    fUseFission = flag;
+}
+
+void PrimaryGeneratorAction::SetPhaseSpaceFile(const G4String& fileName){
+
+    fReplay.Close();
+    fReplayRecycled = false;
+    if (fileName != "none") fReplay.Open(fileName);
+}
+
+G4bool PrimaryGeneratorAction::ReplayPrimary(G4int eventID, G4ThreeVector& position, G4ThreeVector& direction,
+                                             G4double& energy, G4double& weight, G4double& time,
+                                             G4ParticleDefinition*& particle){
+
+    // the event ID picks the record, so every record is used fReplaySplitting
+    // times whatever the thread count or the order the events are dealt in;
+    // the file starts over once the event ID runs past its end
+    uint64_t nRecords = fReplay.GetNumberOfRecords();
+    uint64_t index = static_cast<uint64_t>(eventID) / fReplaySplitting;
+    G4bool exhausted = index >= nRecords;
+    index %= nRecords;
+    if (exhausted && !fReplayRecycled) {
+        G4cout << "\n--> warning from PrimaryGeneratorAction::ReplayPrimary : "
+               << fReplay.GetFileName() << " exhausted, replaying it again" << G4endl;
+        fReplayRecycled = true;
+    }
+    const PhaseSpaceRecord& record = fReplay.Get(index);
+
+    position.set(record.position[0] * mm, record.position[1] * mm, record.position[2] * mm);
+    direction.set(record.direction[0], record.direction[1], record.direction[2]);
+    energy = record.energy * MeV;
+    time = record.time * ns;
+    weight = record.weight / fReplaySplitting;
+
+    // each copy turned by its own angle about the axis through the envelope centre
+    if (fReplayRotation) {
+        G4double angle = twopi * G4UniformRand();
+        G4ThreeVector centre = fReplay.GetCentre();
+        position = centre + (position - centre).rotate(angle, fReplayAxis);
+        direction.rotate(angle, fReplayAxis);
+    }
+
+    particle = G4ParticleTable::GetParticleTable()->FindParticle(record.pdg);
+    if (!particle) particle = G4IonTable::GetIonTable()->GetIon(record.pdg);
+    return particle != nullptr;
+}
+
+G4double PrimaryGeneratorAction::DirectionDensity(const G4ThreeVector& direction) const{
+
+    // probability per steradian of the analog sampling below
+    if (fIsotropic) return 1.0 / (4.0 * pi);
+
+    // theta and phi are uniform in their ranges; (theta, phi) and
+    // (-theta, phi + pi) give the same direction, and phi is periodic
+    G4double deltaTheta = fMaxTheta - fMinTheta;
+    G4double deltaPhi = fMaxPhi - fMinPhi;
+    G4double sinTheta = std::sin(direction.theta());
+    if (deltaTheta <= 0. || deltaPhi <= 0. || sinTheta <= 0.) return 0.;
+
+    G4int preimages = 0;
+    for (G4int sign : {1, -1}) {
+        G4double theta = sign * direction.theta();
+        if (theta < fMinTheta || theta > fMaxTheta) continue;
+        G4double phi = direction.phi() + (sign > 0 ? 0. : pi);
+        G4int kMin = static_cast<G4int>(std::ceil((fMinPhi - phi) / twopi));
+        G4int kMax = static_cast<G4int>(std::floor((fMaxPhi - phi) / twopi));
+        preimages += std::max(0, kMax - kMin + 1);
+    }
+    return preimages / (deltaTheta * deltaPhi * sinTheta);
+}
+
+
+G4bool PrimaryGeneratorAction::SampleBiasedDirection(const G4ThreeVector& position, G4ThreeVector& direction, G4double& weight) const{
+
+    // a pencil beam or a source inside the detector is left analog
+    if (!fIsotropic && (fMaxTheta - fMinTheta <= 0. || fMaxPhi - fMinPhi <= 0.)) return false;
+    G4ThreeVector axis = fDetector->GetBoundingCentre() - position;
+    G4double distance = axis.mag();
+    G4double radius = fDetector->GetBoundingRadius();
+    if (radius <= 0. || distance <= radius) return false;
+
+    // uniform in the cone of half-angle asin(radius / distance)
+    G4double cosAlpha = std::sqrt(1.0 - radius * radius / (distance * distance));
+    G4double cosTheta = cosAlpha + G4UniformRand() * (1.0 - cosAlpha);
+    G4double sinTheta = std::sqrt(std::max(0., 1.0 - cosTheta * cosTheta));
+    G4double phi = twopi * G4UniformRand();
+    direction = G4ThreeVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+    direction.rotateUz(axis.unit());
+
+    // zero when the analog source never emits this way: the event is skipped
+    G4double coneSolidAngle = twopi * (1.0 - cosAlpha);
+    weight = DirectionDensity(direction) * coneSolidAngle;
+    return true;
+}
+
+
+namespace {
+    // SplitMix64 (Steele, Lea, Flood): one well-mixed 64-bit word per call
+    uint64_t SplitMix64(uint64_t& state){
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+}
+
+void PrimaryGeneratorAction::SeedEvent(G4int runID, G4int eventID) const{
+
+    uint64_t state = static_cast<uint64_t>(fRunSeed);
+    state = SplitMix64(state) ^ (static_cast<uint64_t>(static_cast<uint32_t>(runID)) << 32
+                                 | static_cast<uint32_t>(eventID));
+    uint64_t first = SplitMix64(state);
+    uint64_t second = SplitMix64(state);
+
+    // inside the valid ranges of the two RanecuEngine seeds; other engines
+    // take the zero-terminated list as it is
+    long seeds[3] = {1 + static_cast<long>(first % 2147483562ULL),
+                     1 + static_cast<long>(second % 2147483398ULL), 0};
+    G4Random::setTheSeeds(seeds);
+}
+
+G4double PrimaryGeneratorAction::NextEmissionTime(){
+
+    if (fActivity > 0.) fEmissionTime += CLHEP::RandExponential::shoot(1. / fActivity);
+    return fActivity > 0. ? fEmissionTime : 0.;
+}
+
+void PrimaryGeneratorAction::GenerateFission(G4Event* anEvent, G4double time){
+
+    G4ThreeVector position = SamplePosition();
+    fFission.Sample(fFissionEvent, fFissionGammas);
+
+    // one vertex: every particle shares the fission time
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(position, time);
+    G4double neutronEnergy = 0.;
+    for (std::size_t i = 0; i < fFissionEvent.neutronEnergy.size(); i++) {
+        G4PrimaryParticle* neutron = new G4PrimaryParticle(fNeutronDef);
+        neutron->SetKineticEnergy(fFissionEvent.neutronEnergy[i]);
+        neutron->SetMomentumDirection(fFissionEvent.neutronDirection[i]);
+        vertex->SetPrimary(neutron);
+        neutronEnergy += fFissionEvent.neutronEnergy[i];
+    }
+    for (std::size_t i = 0; i < fFissionEvent.gammaEnergy.size(); i++) {
+        G4PrimaryParticle* gamma = new G4PrimaryParticle(fGammaDef);
+        gamma->SetKineticEnergy(fFissionEvent.gammaEnergy[i]);
+        gamma->SetMomentumDirection(fFissionEvent.gammaDirection[i]);
+        vertex->SetPrimary(gamma);
+    }
+    if (vertex->GetNumberOfParticle() > 0) {
+        anEvent->AddPrimaryVertex(vertex);
+    } else {
+        delete vertex;   // no neutron and gammas off: an empty event
+    }
+
+    // one entry per fission: fragment axis, summed neutron energy, multiplicities
+    static const G4int cf252 = 1000982520;
+    fRun->FillInitialConditions(fFissionEvent.axis, position, neutronEnergy, cf252, 1.,
+                                static_cast<G4int>(fFissionEvent.neutronEnergy.size()),
+                                static_cast<G4int>(fFissionEvent.gammaEnergy.size()));
+}
+
+
+void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent){
+
+    // a new run may come with new /source/ settings
+    G4int runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+    if (runID != fBatchRunID) {
+        ResetBatch();
+        fBatchRunID = runID;
+        fEmissionTime = 0.;
+    }
+    if (fEventSeeding) SeedEvent(runID, anEvent->GetEventID());
+
+    G4ThreeVector position, direction;
+    G4double energy, weight, time = 0.;
+    G4ParticleDefinition* particle = fParticleDef;
+    if (fReplay.IsOpen()) {
+        if (!ReplayPrimary(anEvent->GetEventID(), position, direction, energy, weight, time, particle)) {
+            particle = fParticleDef;
+            weight = 0.;   // unknown PDG code: skip the event
+        }
+    } else if (fUseFission) {
+        GenerateFission(anEvent, NextEmissionTime());
+        return;
+    } else {
+        NextPrimary(position, direction, energy, weight);
+    }
+    time += NextEmissionTime();
+    fParticleGun->SetParticleDefinition(particle);
+    fParticleGun->SetParticleEnergy(energy);
+    fParticleGun->SetParticlePosition(position);
+    fParticleGun->SetParticleMomentumDirection(direction);
+    fParticleGun->SetParticleTime(time);
+
    //////////////////////////////////////////////////////////////
    // Print particle settings for this generation
 
@@ -192,14 +579,19 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent){
       G4cout << "Total Energy: " << totalEnergy / MeV << " MeV" << G4endl; // Convert to MeV
       G4cout << " ******************************************************* " << G4endl;
     }
-    // Generate the primary vertex for the event
-    fParticleGun->GeneratePrimaryVertex(anEvent);
+    // Generate the primary vertex for the event; the vertex weight is
+    // inherited by every track, so biased events are scored with it
+    if (weight > 0.) {
+        fParticleGun->GeneratePrimaryVertex(anEvent);
+        anEvent->GetPrimaryVertex()->SetWeight(weight);
+    }
 
 
     fRun->FillInitialConditions(fParticleGun->GetParticleMomentumDirection(),
                                 fParticleGun->GetParticlePosition(),
                                 fParticleGun->GetParticleEnergy(),
-                                fParticleDef->GetParticleName()
+                                particle->GetPDGEncoding(),
+                                weight
                                 );
 }
 
@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file RecoilFastSimModel.cc
+/// \brief Implementation of the RecoilFastSimModel class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "RecoilFastSimModel.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Track.hh"
+#include "G4Proton.hh"
+#include "G4VSolid.hh"
+#include "G4Material.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RecoilFastSimModel::RecoilFastSimModel(const G4String& name, G4Region* region, const DetectorConstruction* detector)
+ : G4VFastSimulationModel(name, region),
+   fDetector(detector)
+{}
+
+RecoilFastSimModel::~RecoilFastSimModel()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool RecoilFastSimModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+  // protons and every ion (carbon recoils, alphas) share the hadron-ion EM models
+  return &particle == G4Proton::Definition() || particle.GetParticleType() == "nucleus";
+}
+
+
+G4bool RecoilFastSimModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  G4double energy = track->GetKineticEnergy();
+  if (energy <= 0.) return false;
+
+  G4double safety = fastTrack.GetEnvelopeSolid()->DistanceToOut(fastTrack.GetPrimaryTrackLocalPosition());
+  G4double range = fCalculator.GetRange(energy, track->GetParticleDefinition(), track->GetMaterial());
+
+  return range < fDetector->GetRecoilSafetyFraction() * safety;
+}
+
+
+void RecoilFastSimModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  G4double energy = track->GetKineticEnergy();
+
+  // the deposit is reported on this step, so SteppingAction scores it in
+  // the crystal of the pre-step point as for a tracked recoil
+  fastStep.KillPrimaryTrack();
+  fastStep.ProposePrimaryTrackPathLength(fCalculator.GetRange(energy, track->GetParticleDefinition(), track->GetMaterial()));
+  fastStep.ProposeTotalEnergyDeposited(energy);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
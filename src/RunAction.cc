@@ -33,7 +33,10 @@
 #include "RunAction.hh"
 //#include "Run.hh"
 #include "DetectorConstruction.hh"
+#include "DetectorResponse.hh"
+#include "PhaseSpaceRecorder.hh"
 #include "PrimaryGeneratorAction.hh"
+#include "PhysicsList.hh"
 //#include "HistoManager.hh"
 #include "G4AccumulableManager.hh"
 
@@ -42,15 +45,46 @@
 #include "G4SystemOfUnits.hh"
 #include "G4RunManager.hh"
 #include "Randomize.hh"
+#include "G4Poisson.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include <cmath>
 #include <iomanip>
+#include <algorithm>
 
 
 
 
+namespace {
+  G4Mutex checksumMutex = G4MUTEX_INITIALIZER;
+  // set by the master's BeginOfRunAction, which runs before any worker's
+  // events under both the MT and the tasking run managers
+  RunAction* masterRunAction = nullptr;
+  // resolution of the checksum sums; a 10 MeV deposit is 1e10 units
+  const G4double kChecksumQuantum = 1.e-3 * eV;
+  // crystals listed one by one in the run summary
+  const size_t kMaxPrintedCrystals = 16;
+}
+
 RunAction::RunAction(DetectorConstruction* det)
   : G4UserRunAction(),
     fDetector(det), fRootFile(0), fTree(0)
 {
+    G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+    accumulableManager->RegisterAccumulable(fNumberOfHitEvents);
+    accumulableManager->RegisterAccumulable(fTotalEdep);
+    accumulableManager->RegisterAccumulable(fNumberOfSteps);
+    accumulableManager->RegisterAccumulable(fNumberOfLocalDeposits);
+    accumulableManager->RegisterAccumulable(fKilledEnvelope);
+    accumulableManager->RegisterAccumulable(fKilledTime);
+    accumulableManager->RegisterAccumulable(fKilledEnergy);
+    accumulableManager->RegisterAccumulable(fPhaseSpaceRecords);
+    accumulableManager->RegisterAccumulable(fBuiltEvents);
+    accumulableManager->RegisterAccumulable(fBuilderPulses);
+    accumulableManager->RegisterAccumulable(fPiledUpPulses);
+    accumulableManager->RegisterAccumulable(fDeadTimeLosses);
+    accumulableManager->RegisterAccumulable(fRandomCoincidences);
+
     //fscoringVolumes  = fDetector->GetScoringVolumes();
 //
     //if(!fDetector){
@@ -71,32 +105,100 @@ RunAction::~RunAction(){}
 ////////////////////////////////////////////////////////////
 
 
-void RunAction::BeginOfRunAction(const G4Run*){
+void RunAction::BeginOfRunAction(const G4Run* run){
+
+  G4AccumulableManager::Instance()->Reset();
+
+  if (IsMaster() && run->GetRunID() == 0) {
+    auto physics = dynamic_cast<const PhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList());
+    if (physics) physics->PrintStartupReport();
+  }
+  // the map and the light tables are shared: ready on the master before
+  // any worker starts its events
+  if (IsMaster()) {
+    masterRunAction = this;
+    fDetector->GetResponse()->PrepareLightCollection();
+    fDetector->GetResponse()->PrepareStoppingLight();
+  }
+
+  // the workers write the phase space, or the master in sequential mode
+  const PhaseSpaceRecorder* recorder = fDetector->GetPhaseSpaceRecorder();
+  if (recorder->IsRecording()) {
+    if (!G4Threading::IsMasterThread()) {
+      fPhaseSpaceWriter.Open(recorder->GetFileName(run->GetRunID(), G4Threading::G4GetThreadId()),
+                             recorder->GetCentre(), recorder->GetRadius());
+    } else if (!G4Threading::IsMultithreadedApplication()) {
+      fPhaseSpaceWriter.Open(recorder->GetFileName(run->GetRunID()), recorder->GetCentre(), recorder->GetRadius());
+    }
+  }
+  fTimer.Start();
     
   auto now = std::chrono::system_clock::now();
   auto in_time_t = std::chrono::system_clock::to_time_t(now);
   std::stringstream ss;
   ss << std::put_time(std::localtime(&in_time_t), "%Y%m%d_%H%M%S");
+
+  // one file per run and per thread, so back-to-back runs in one process
+  // (e.g. after /detector/update) never overwrite each other
+  ss << "_run" << run->GetRunID();
+  if (!G4Threading::IsMasterThread()) ss << "_t" << G4Threading::G4GetThreadId();
   std::string filename = "simTree_" + ss.str() + ".root";
 
   fRootFile = new TFile(filename.c_str(), "RECREATE");
   
-  fTree = new TTree("simEvents", "simEvents");
-  fTree->Branch("ScoringName", &fVolumeNames);
-  fTree->Branch("Energy", &fEdepValues);
-
-
-  fPrimaryTree = new TTree("primaryConditions", "primaryConditions");
-  fPrimaryTree->Branch("SourcePosition", &SourcePosition);
-  fPrimaryTree->Branch("BeamDirection", &BeamDirection);
-  fPrimaryTree->Branch("BeamEnergy", &BeamEnergy);
-  fPrimaryTree->Branch("BeamName", &beamName);
+  fTree = new TTree(EventSchema::kEventTree, "simEvents");
+  fEventRecord.Reserve(static_cast<Int_t>(fDetector->scoringHandles.size()));
+  EventSchema::BindWriter(fTree, fEventRecord);
+
+  fPrimaryTree = new TTree(EventSchema::kPrimaryTree, "primaryConditions");
+  EventSchema::BindWriter(fPrimaryTree, fPrimaryRecord);
+
+  fDetectorTree = new TTree(EventSchema::kGeometryTree, "Detector Conditions");
+  EventSchema::BindWriter(fDetectorTree, fGeometryRecord);
+
+  fCrystalChecksum.assign(fDetector->scoringHandles.size(), 0);
+  fCrystalWeightedHits.assign(fDetector->scoringHandles.size(), 0.);
+
+  fBuiltTree = nullptr;
+  const EventBuilder::Settings& builder = fDetector->GetResponse()->GetBuilderSettings();
+  G4bool building = builder.enabled;
+
+  // without an activity every primary starts at t = 0: nothing would be
+  // final before the end of the run and everything would pile up
+  auto primary = dynamic_cast<const PrimaryGeneratorAction*>(G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
+  if (building && primary && primary->GetActivity() <= 0.) {
+    if (G4Threading::G4GetThreadId() <= 0) {
+      G4cout << "\n--> warning from RunAction::BeginOfRunAction : "
+             << "event building needs /source/activity > 0, disabled for this run" << G4endl;
+    }
+    building = false;
+  }
+  if (building) {
+    fBuiltTree = new TTree(EventSchema::kBuiltTree, "Built Events");
+    fBuiltRecord.Reserve(static_cast<Int_t>(fDetector->scoringHandles.size()));
+    EventSchema::BindWriter(fBuiltTree, fBuiltRecord);
+    fBuilder.Start(builder, static_cast<G4int>(fDetector->scoringHandles.size()),
+                   [this](const EventBuilder::BuiltEvent& built) {
+                     fBuiltRecord.Fill(built);
+                     fBuiltTree->Fill();
+                   });
+  }
 
-  fDetectorTree = new TTree("detectorConditions", "Detector Conditions");
-  fDetectorTree->Branch("ScoringName", &ScoringName);
-  fDetectorTree->Branch("ScoringLocation", &ScoringLocation);
-  fDetectorTree->Branch("ScoringMaterial", &ScoringMaterial);
-  fDetectorTree->Branch("ScoringSize", &ScoringSize);
+  // created after the file, so the file owns and writes them
+  fEdepHists.resize(fDetector->scoringHandles.size());
+  for (size_t i = 0; i < fEdepHists.size(); ++i) {
+    std::string name = "hEdep_" + std::to_string(i);
+    std::string title = fDetector->scoringHandles[i] + " weighted energy deposit;Energy (MeV);Weighted counts";
+    fEdepHists[i] = new TH1D(name.c_str(), title.c_str(), 1000, 0., 10.);
+    fEdepHists[i]->Sumw2();
+  }
+  fLightHists.resize(fDetector->scoringHandles.size());
+  for (size_t i = 0; i < fLightHists.size(); ++i) {
+    std::string name = "hLight_" + std::to_string(i);
+    std::string title = fDetector->scoringHandles[i] + " weighted light output;Light (MeVee);Weighted counts";
+    fLightHists[i] = new TH1D(name.c_str(), title.c_str(), 1000, 0., 10.);
+    fLightHists[i]->Sumw2();
+  }
 
 
 }
@@ -106,26 +208,94 @@ void RunAction::BeginOfRunAction(const G4Run*){
 ////////////////////////////////////////////////////////////
 void RunAction::EndOfRunAction(const G4Run* run){
 
-  ScoringName.clear();
-  ScoringLocation.clear();
-  ScoringMaterial.clear();
-  ScoringSize.clear();
-  ScoringName       = fDetector->scoringHandles;
-  ScoringMaterial  =  fDetector-> scoringMaterialNames;
-
-
-  for (const auto& g4vec : fDetector-> scoringSizes) {
-      TVector3 rootVec(g4vec.x(), g4vec.y(), g4vec.z());
-      ScoringSize.push_back(rootVec);
+  fPhaseSpaceRecords += static_cast<G4long>(fPhaseSpaceWriter.Close());
+  if (fBuiltTree) {
+    fBuilder.Flush();
+    const EventBuilder::Counters& counters = fBuilder.GetCounters();
+    fBuiltEvents += counters.builtEvents;
+    fBuilderPulses += counters.pulses;
+    fPiledUpPulses += counters.piledUp;
+    fDeadTimeLosses += counters.lost;
+    fRandomCoincidences += counters.randomCoincidences;
   }
-
-  for (const auto& g4vec : fDetector-> scoringPlacements) {
-      TVector3 rootVec(g4vec.x(), g4vec.y(), g4vec.z());
-      ScoringLocation.push_back(rootVec);
+  G4AccumulableManager::Instance()->Merge();
+  if (!IsMaster()) MergeCrystalSums();
+  fTimer.Stop();
+  fRunTime = fTimer.GetRealElapsed();
+  fNumberOfEvents = run->GetNumberOfEvent();
+  fRunID = run->GetRunID();
+
+  if (IsMaster() && fNumberOfEvents > 0) {
+    G4cout << " ============================================ " << G4endl;
+    G4cout << " Run " << run->GetRunID() << ": " << fNumberOfEvents << " events in "
+           << fRunTime << " s (" << fNumberOfEvents / fRunTime << " events/s)" << G4endl;
+    G4cout << " Events with a crystal deposit: " << fNumberOfHitEvents.GetValue()
+           << " (" << 100. * fNumberOfHitEvents.GetValue() / fNumberOfEvents << " %)" << G4endl;
+    // per crystal: a track-biased event has no single weight
+    G4double weightedHits = 0.;
+    for (G4double hits : fCrystalWeightedHits) weightedHits += hits;
+    G4cout << " Weighted crystal hits per event: " << weightedHits / fNumberOfEvents << G4endl;
+    if (fCrystalWeightedHits.size() <= kMaxPrintedCrystals) {
+      for (size_t i = 0; i < fCrystalWeightedHits.size(); ++i) {
+        G4cout << "   weighted hit efficiency " << fDetector->scoringHandles[i] << ": "
+               << fCrystalWeightedHits[i] / fNumberOfEvents << G4endl;
+      }
+    }
+    G4cout << " Total crystal deposit: " << G4BestUnit(fTotalEdep.GetValue(), "Energy") << G4endl;
+    G4cout << " Steps: " << fNumberOfSteps.GetValue() << " ("
+           << static_cast<G4double>(fNumberOfSteps.GetValue()) / fNumberOfEvents << " per event, "
+           << fNumberOfSteps.GetValue() / fRunTime << " per s)" << G4endl;
+    if (fNumberOfLocalDeposits.GetValue() > 0) {
+      G4cout << " Secondaries deposited locally: " << fNumberOfLocalDeposits.GetValue() << G4endl;
+    }
+    if (fKilledEnvelope.GetValue() + fKilledTime.GetValue() + fKilledEnergy.GetValue() > 0) {
+      G4cout << " Tracks killed: " << fKilledEnvelope.GetValue() << " outside the envelope, "
+             << fKilledTime.GetValue() << " by the time cut, "
+             << fKilledEnergy.GetValue() << " below the neutron energy floor" << G4endl;
+    }
+    if (fDetector->GetPhaseSpaceRecorder()->IsRecording()) {
+      const PhaseSpaceRecorder* recorder = fDetector->GetPhaseSpaceRecorder();
+      if (G4Threading::IsMultithreadedApplication()) {
+        recorder->MergeThreadFiles(run->GetRunID(), G4Threading::GetNumberOfRunningWorkerThreads());
+      }
+      G4cout << " Phase-space records: " << fPhaseSpaceRecords.GetValue() << " in "
+             << recorder->GetFileName(run->GetRunID()) << G4endl;
+    }
+    // FNV-1a over the per-crystal sums: compare between thread counts
+    // with /source/seeding/enable (reproducibility.mac)
+    uint64_t checksum = 0xcbf29ce484222325ULL;
+    for (G4long sum : fCrystalChecksum) {
+      checksum = (checksum ^ static_cast<uint64_t>(sum)) * 0x100000001b3ULL;
+    }
+    G4cout << " Deposit checksum: " << std::hex << std::setw(16) << std::setfill('0') << checksum
+           << std::dec << std::setfill(' ') << " (" << fCrystalChecksum.size() << " crystals)" << G4endl;
+    if (fBuilderPulses.GetValue() > 0) {
+      const G4double pulses = static_cast<G4double>(fBuilderPulses.GetValue());
+      G4cout << " Built events: " << fBuiltEvents.GetValue() << " from "
+             << fBuilderPulses.GetValue() << " pulses; piled up "
+             << 100. * fPiledUpPulses.GetValue() / pulses << " %, lost in dead time "
+             << 100. * fDeadTimeLosses.GetValue() / pulses << " %, random coincidences "
+             << fRandomCoincidences.GetValue() << G4endl;
+    }
+    G4cout << " ============================================ " << G4endl;
   }
 
-
-  fDetectorTree->Fill();
+  // one entry per scoring volume
+  for (size_t i = 0; i < fDetector->scoringHandles.size(); ++i) {
+    const G4ThreeVector& location = fDetector->scoringPlacements[i];
+    const G4ThreeVector& size     = fDetector->scoringSizes[i];
+
+    fGeometryRecord.index = static_cast<Int_t>(i);
+    EventSchema::CopyName(fGeometryRecord.name, fDetector->scoringHandles[i]);
+    EventSchema::CopyName(fGeometryRecord.material, fDetector->scoringMaterialNames[i]);
+    fGeometryRecord.location[0] = location.x();
+    fGeometryRecord.location[1] = location.y();
+    fGeometryRecord.location[2] = location.z();
+    fGeometryRecord.size[0] = size.x();
+    fGeometryRecord.size[1] = size.y();
+    fGeometryRecord.size[2] = size.z();
+    fDetectorTree->Fill();
+  }
 
 
 
@@ -135,43 +305,128 @@ void RunAction::EndOfRunAction(const G4Run* run){
   fTree->Write();
   fPrimaryTree->Write();
   fDetectorTree->Write();
+  if (fBuiltTree) fBuiltTree->Write();
+  for (auto* hist : fEdepHists) hist->Write();
+  for (auto* hist : fLightHists) hist->Write();
+  fEdepHists.clear();   // deleted with the file
+  fLightHists.clear();
 
 
   fRootFile->Close();
+  fBuiltTree = nullptr;   // deleted with the file
   return;
 }
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
 
-void RunAction::FillPerEvent(const std::map<G4String, G4double>& edepMap) {
-
-    fVolumeNames.clear();
-    fEdepValues.clear();
-
-    for (const auto& entry : edepMap) {
-        fVolumeNames.push_back(entry.first);
-        fEdepValues.push_back(entry.second);
+void RunAction::FillPerEvent(const CrystalDeposits& deposits, G4double sourceWeight) {
+
+    const std::vector<G4double>& edep = deposits.edep;
+    const std::vector<G4double>& light = deposits.light;
+
+    // each crystal is filled and counted with the deposit-weighted mean
+    // weight of the tracks that deposited in it, so a biased track only
+    // counts with its own weight. There is no such weight for the whole
+    // event: under forced collisions the crystals of one event carry
+    // different weights, and any average of them is biased.
+    G4double eventEdep = 0.;
+    for (size_t i = 0; i < edep.size(); ++i) {
+      if (edep[i] <= 0.) continue;
+      eventEdep += edep[i];
+      G4double weight = deposits.EdepWeight(i, sourceWeight);
+      fCrystalChecksum[i] += std::llround(edep[i] / kChecksumQuantum);
+      fCrystalWeightedHits[i] += weight;
+      fEdepHists[i]->Fill(edep[i] / MeV, weight);
+      fLightHists[i]->Fill(light[i] / MeV, deposits.LightWeight(i, weight));
     }
+    if (eventEdep > 0.) fNumberOfHitEvents += 1;
+    fTotalEdep += eventEdep;
+
+    // same indexing as the geometry tree, so index i means the same volume everywhere
+    fEventRecord.Fill(deposits);
+    fEventRecord.weight = sourceWeight;
 
     // Fill the tree for this event
     fTree->Fill();
 }
 
 
+void RunAction::BuildEvents(const CrystalDeposits& deposits, G4int eventID, G4double emissionTime) {
+    if (!fBuiltTree) return;
+
+    // deposits of a crystal within one integration time of the first make
+    // one pulse; a later deposit opens the next. The photoelectrons of each
+    // pulse are sampled from its own mean.
+    fTimedDeposits.assign(deposits.timed.begin(), deposits.timed.end());
+    std::sort(fTimedDeposits.begin(), fTimedDeposits.end(),
+              [](const CrystalDeposits::TimedDeposit& a, const CrystalDeposits::TimedDeposit& b) {
+                return a.index != b.index ? a.index < b.index : a.time < b.time;
+              });
+    const G4double integrationTime = fBuilder.GetSettings().integrationTime;
+    for (size_t first = 0; first < fTimedDeposits.size(); ) {
+      EventBuilder::Pulse pulse = {fTimedDeposits[first].time, fTimedDeposits[first].index, eventID, 0., 0., 0.};
+      size_t next = first;
+      while (next == first || (next < fTimedDeposits.size() && fTimedDeposits[next].index == pulse.crystal
+                               && fTimedDeposits[next].time < pulse.time + integrationTime)) {
+        pulse.edep += fTimedDeposits[next].edep;
+        pulse.light += fTimedDeposits[next].light;
+        pulse.photoElectrons += fTimedDeposits[next].photoElectrons;
+        ++next;
+      }
+      if (pulse.photoElectrons > 0.) pulse.photoElectrons = G4Poisson(pulse.photoElectrons);
+      if (pulse.edep > 0.) fBuilder.AddPulse(pulse);
+      first = next;
+    }
+    // primaries are emitted in time order: nothing later can precede this one
+    fBuilder.Process(emissionTime);
+}
+
+
+void RunAction::MergeCrystalSums() {
+    // same hand-over as the accumulables: the master's end of run comes
+    // after every worker's
+    RunAction* master = masterRunAction;
+    if (!master) return;
+    G4AutoLock lock(&checksumMutex);
+    for (size_t i = 0; i < fCrystalChecksum.size() && i < master->fCrystalChecksum.size(); ++i) {
+      master->fCrystalChecksum[i] += fCrystalChecksum[i];
+      master->fCrystalWeightedHits[i] += fCrystalWeightedHits[i];
+    }
+}
+
+
+void RunAction::AddTrackingCounts(G4long steps, G4long localDeposits) {
+    fNumberOfSteps += steps;
+    fNumberOfLocalDeposits += localDeposits;
+}
+
+void RunAction::AddKilledTracks(G4long envelope, G4long time, G4long energy) {
+    fKilledEnvelope += envelope;
+    fKilledTime += time;
+    fKilledEnergy += energy;
+}
+
+
 void RunAction::FillInitialConditions(const G4ThreeVector& Direction,
                                     const G4ThreeVector& Position,
                                     const G4double& Energy,
-                                    const std::string name) {
-
-  BeamDirection.Clear();
-  SourcePosition.Clear();
-  BeamEnergy=-10000;
-
-  BeamDirection  = TVector3(Direction.x(),Direction.y(), Direction.z());
-  SourcePosition = TVector3(Position.x(),Position.y(), Position.z());
-  BeamEnergy = Energy;
-  beamName = name;
+                                    const G4int pdg,
+                                    const G4double weight,
+                                    const G4int fissionNeutrons,
+                                    const G4int fissionGammas) {
+
+  fPrimaryRecord.direction[0] = Direction.x();
+  fPrimaryRecord.direction[1] = Direction.y();
+  fPrimaryRecord.direction[2] = Direction.z();
+  fPrimaryRecord.position[0] = Position.x();
+  fPrimaryRecord.position[1] = Position.y();
+  fPrimaryRecord.position[2] = Position.z();
+  fPrimaryRecord.energy = Energy;
+  fPrimaryRecord.pdg = pdg;
+  fPrimaryRecord.weight = weight;
+  fPrimaryRecord.fissionNeutrons = fissionNeutrons;
+  fPrimaryRecord.fissionGammas = fissionGammas;
 
   fPrimaryTree->Fill();
 
@@ -0,0 +1,123 @@
+
+
+#include "ScanMessenger.hh"
+
+#include "ParameterScan.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include <sstream>
+
+
+
+ScanMessenger::ScanMessenger(ParameterScan* scan)
+ : G4UImessenger(),
+   fScan(scan)
+{
+
+  G4bool broadcast = false;
+  fScanDir = new G4UIdirectory("/scan/",broadcast);
+  fScanDir->SetGuidance("Parameter sweeps over geometry and source settings in one process");
+
+  fAddParameterCmd = new G4UIcommand("/scan/addParameter", this);
+  fAddParameterCmd->SetGuidance("Add a scanned parameter: name min max nPoints unit.");
+  fAddParameterCmd->SetGuidance("Names: crystalSize greaseThickness barSpacing coverThickness energy.");
+  fAddParameterCmd->SetGuidance("nPoints is the grid size; ignored for Latin-hypercube sampling.");
+  G4UIparameter* namePrm = new G4UIparameter("name", 's', false);
+  namePrm->SetParameterCandidates("crystalSize greaseThickness barSpacing coverThickness energy");
+  fAddParameterCmd->SetParameter(namePrm);
+  fAddParameterCmd->SetParameter(new G4UIparameter("min", 'd', false));
+  fAddParameterCmd->SetParameter(new G4UIparameter("max", 'd', false));
+  G4UIparameter* pointsPrm = new G4UIparameter("nPoints", 'i', false);
+  pointsPrm->SetParameterRange("nPoints>0");
+  fAddParameterCmd->SetParameter(pointsPrm);
+  fAddParameterCmd->SetParameter(new G4UIparameter("unit", 's', false));
+  fAddParameterCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/scan/clear", this);
+  fClearCmd->SetGuidance("Remove all scanned parameters.");
+  fClearCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fModeCmd = new G4UIcmdWithAString("/scan/mode", this);
+  fModeCmd->SetGuidance("Full grid or Latin-hypercube sampling.");
+  fModeCmd->SetParameterName("mode", false);
+  fModeCmd->SetCandidates("grid lhs");
+  fModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSamplesCmd = new G4UIcmdWithAnInteger("/scan/samples", this);
+  fSamplesCmd->SetGuidance("Number of Latin-hypercube samples.");
+  fSamplesCmd->SetParameterName("nSamples", false);
+  fSamplesCmd->SetRange("nSamples>0");
+  fSamplesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEventsPerPointCmd = new G4UIcmdWithAnInteger("/scan/eventsPerPoint", this);
+  fEventsPerPointCmd->SetGuidance("Number of events simulated at every point.");
+  fEventsPerPointCmd->SetParameterName("nEvents", false);
+  fEventsPerPointCmd->SetRange("nEvents>0");
+  fEventsPerPointCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSummaryFileCmd = new G4UIcmdWithAString("/scan/summaryFile", this);
+  fSummaryFileCmd->SetGuidance("CSV file with one row per scan point.");
+  fSummaryFileCmd->SetParameterName("fileName", false);
+  fSummaryFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fUseEngineCmd = new G4UIcmdWithABool("/scan/useEngine", this);
+  fUseEngineCmd->SetGuidance("Run every point with the NeutronEngine (/engine/) instead of Geant4.");
+  fUseEngineCmd->SetParameterName("flag", false);
+  fUseEngineCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRunCmd = new G4UIcmdWithoutParameter("/scan/run", this);
+  fRunCmd->SetGuidance("Run every point of the scan.");
+  fRunCmd->AvailableForStates(G4State_Idle);
+
+}
+ScanMessenger::~ScanMessenger()
+{
+  delete fAddParameterCmd;
+  delete fClearCmd;
+  delete fModeCmd;
+  delete fSamplesCmd;
+  delete fEventsPerPointCmd;
+  delete fSummaryFileCmd;
+  delete fUseEngineCmd;
+  delete fRunCmd;
+  delete fScanDir;
+}
+
+void ScanMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
+
+  if (command == fAddParameterCmd) {
+    G4String name, unit;
+    G4double min, max;
+    G4int nPoints;
+    std::istringstream is(newValue);
+    is >> name >> min >> max >> nPoints >> unit;
+    fScan->AddParameter(name, min, max, nPoints, unit);
+  }
+  else if (command == fClearCmd) {
+    fScan->ClearParameters();
+  }
+  else if (command == fModeCmd) {
+    fScan->SetLatinHypercube(newValue == "lhs");
+  }
+  else if (command == fSamplesCmd) {
+    fScan->SetNumberOfSamples(fSamplesCmd->GetNewIntValue(newValue));
+  }
+  else if (command == fEventsPerPointCmd) {
+    fScan->SetEventsPerPoint(fEventsPerPointCmd->GetNewIntValue(newValue));
+  }
+  else if (command == fSummaryFileCmd) {
+    fScan->SetSummaryFile(newValue);
+  }
+  else if (command == fUseEngineCmd) {
+    fScan->SetUseEngine(fUseEngineCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fRunCmd) {
+    fScan->Run();
+  }
+
+}
@@ -0,0 +1,120 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file SourceShape.cc
+/// \brief Implementation of the SourceShape class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "SourceShape.hh"
+
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool SourceShape::SetType(const G4String& name)
+{
+  if (name == "point")              fType = kPoint;
+  else if (name == "box")           fType = kBox;
+  else if (name == "disk")          fType = kDisk;
+  else if (name == "cylinder")      fType = kCylinder;
+  else if (name == "sphereSurface") fType = kSphereSurface;
+  else if (name == "sphereVolume")  fType = kSphereVolume;
+  else {
+    G4cout << "\n--> warning from SourceShape::SetType : unknown shape " << name << G4endl;
+    return false;
+  }
+  return true;
+}
+
+
+G4String SourceShape::Describe() const
+{
+  std::ostringstream os;
+  switch (fType) {
+    case kPoint:
+      os << "point";
+      break;
+    case kBox:
+      os << "box, half sizes " << fHalfSize / mm << " mm";
+      break;
+    case kDisk:
+      os << "disk, radius " << fRadius / mm << " mm";
+      break;
+    case kCylinder:
+      os << "cylinder, radius " << fRadius / mm << " mm, half length " << fHalfLength / mm << " mm";
+      break;
+    case kSphereSurface:
+      os << "sphere surface, radius " << fRadius / mm << " mm";
+      break;
+    case kSphereVolume:
+      os << "sphere volume, radius " << fRadius / mm << " mm";
+      break;
+  }
+  if (fType != kPoint && fType != kSphereSurface && fType != kSphereVolume) os << ", axis " << fAxis;
+  return os.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector SourceShape::Sample(const G4ThreeVector& centre, G4double u, G4double v, G4double w) const
+{
+  G4ThreeVector local;
+  switch (fType) {
+    case kPoint:
+      return centre;
+    case kBox:
+      local.set((2. * u - 1.) * fHalfSize.x(), (2. * v - 1.) * fHalfSize.y(), (2. * w - 1.) * fHalfSize.z());
+      break;
+    case kDisk:
+    case kCylinder: {
+      // uniform in area: the radius goes as the square root
+      G4double r = fRadius * std::sqrt(u);
+      G4double phi = twopi * v;
+      G4double z = fType == kCylinder ? (2. * w - 1.) * fHalfLength : 0.;
+      local.set(r * std::cos(phi), r * std::sin(phi), z);
+      break;
+    }
+    case kSphereSurface:
+    case kSphereVolume: {
+      // uniform in volume: the radius goes as the cube root
+      G4double cosTheta = 1. - 2. * u;
+      G4double sinTheta = std::sqrt(std::max(0., 1. - cosTheta * cosTheta));
+      G4double phi = twopi * v;
+      G4double r = fType == kSphereVolume ? fRadius * std::cbrt(w) : fRadius;
+      // isotropic: no need to orient
+      return centre + G4ThreeVector(r * sinTheta * std::cos(phi), r * sinTheta * std::sin(phi), r * cosTheta);
+    }
+  }
+  return centre + local.rotateUz(fAxis);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,102 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file StackingAction.cc
+/// \brief Implementation of the StackingAction class
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "StackingAction.hh"
+#include "EventAction.hh"
+#include "DetectorConstruction.hh"
+#include "PhysicsList.hh"
+#include "DetectorResponse.hh"
+
+#include "G4Track.hh"
+#include "G4Electron.hh"
+#include "G4Gamma.hh"
+#include "G4Neutron.hh"
+#include "G4NavigationHistory.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::StackingAction(EventAction* event, DetectorConstruction* det, const PhysicsList* physics)
+: G4UserStackingAction(), fEventAction(event), fDetector(det), fPhysicsList(physics)
+{}
+
+
+StackingAction::~StackingAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  if (!fPhysicsList || track->GetParentID() == 0) return fUrgent;
+  const G4ParticleDefinition* particle = track->GetDefinition();
+
+  // secondaries already past the kill policies are never tracked
+  G4double timeCut = fPhysicsList->GetKillTime();
+  if (timeCut > 0. && track->GetGlobalTime() - fEventAction->GetEmissionTime() > timeCut) {
+    fEventAction->CountKilled(EventAction::kKillTime);
+    return fKill;
+  }
+  G4double floor = fPhysicsList->GetNeutronEnergyFloor();
+  if (floor > 0. && particle == G4Neutron::Definition() && track->GetKineticEnergy() < floor) {
+    fEventAction->CountKilled(EventAction::kKillEnergy);
+    return fKill;
+  }
+
+  G4double threshold = fPhysicsList->GetLocalDepositThreshold();
+  if (threshold <= 0.) return fUrgent;
+
+  if (particle != G4Electron::Definition() && particle != G4Gamma::Definition()) return fUrgent;
+
+  G4double energy = track->GetKineticEnergy();
+  if (energy >= threshold) return fUrgent;
+
+  // secondaries inherit the touchable of their parent's current step
+  const G4VTouchable* touchable = track->GetTouchable();
+  if (touchable) {
+    G4int index = fDetector->GetScoringIndex(touchable);
+    if (index >= 0) {
+      // electron-equivalent: light = energy
+      const DetectorResponse* response = fDetector->GetResponse();
+      G4double photoElectrons = 0.;
+      if (response->UseLightCollection()) {
+        G4ThreeVector local = touchable->GetHistory()->GetTopTransform().TransformPoint(track->GetPosition());
+        photoElectrons = response->PhotoElectronMean(index, local, energy);
+      }
+      fEventAction->AddEdep(index, DetectorResponse::kElectron, energy, energy, photoElectrons,
+                            track->GetGlobalTime(), track->GetWeight());
+    }
+  }
+  fEventAction->CountLocalDeposit();
+  return fKill;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -35,54 +35,131 @@
 #include "EventAction.hh"
 //#include "HistoManager.hh"
 #include "DetectorConstruction.hh"
+#include "PhysicsList.hh"
+#include "DetectorResponse.hh"
+#include "PhaseSpaceRecorder.hh"
 #include "G4Neutron.hh"
 #include "G4Proton.hh"
 #include "G4VisAttributes.hh"
 #include "G4Color.hh"
 
 #include "G4RunManager.hh"
+#include "G4Step.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4VProcess.hh"
+#include "G4NavigationHistory.hh"
                            
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-SteppingAction::SteppingAction(EventAction* event,DetectorConstruction* det)
-: G4UserSteppingAction(), fEventAction(event), fDetector(det){ }
+SteppingAction::SteppingAction(EventAction* event,DetectorConstruction* det, const PhysicsList* physics)
+: G4UserSteppingAction(), fEventAction(event), fDetector(det), fPhysicsList(physics){ }
 
 
 SteppingAction::~SteppingAction(){ }
 
 
 void SteppingAction::UserSteppingAction(const G4Step* step) {
-    
 
-    G4LogicalVolume* hitVolume 
-      = step->GetPreStepPoint()->GetTouchableHandle()
-        ->GetVolume()->GetLogicalVolume();
+    fEventAction->CountStep();
+
+    G4double edepStep = step->GetTotalEnergyDeposit();
+    if (edepStep > 0.) {
+        // dense crystal index from the copy number, no string comparisons per step
+        G4int index = fDetector->GetScoringIndex(step->GetPreStepPoint()->GetTouchable());
+        if (index >= 0) {
+            G4int species = Species(step->GetTrack()->GetDefinition());
+            G4double light = Light(step, species, edepStep);
+            fEventAction->AddEdep(index, species, edepStep, light, PhotoElectrons(step, index, light),
+                                  step->GetPreStepPoint()->GetGlobalTime(), step->GetTrack()->GetWeight());
+        }
+    }
 
-    const G4Track* track = step->GetTrack();
-    const G4ParticleDefinition* particle = track->GetParticleDefinition();
+    G4Track* track = step->GetTrack();
+    const PhaseSpaceRecorder* recorder = fDetector->GetPhaseSpaceRecorder();
+    if (recorder->IsRecording()) {
+        PhaseSpaceRecord record;
+        if (recorder->Crossing(step, record)) {
+            fEventAction->RecordPhaseSpace(record);
+            if (recorder->GetKillAtEnvelope()) track->SetTrackStatus(fStopAndKill);
+        }
+    }
+    if (fPhysicsList && track->GetTrackStatus() == fAlive) ApplyKillPolicies(track);
+}
 
-    if (particle) {
-      for (auto& scoringHanlde : fDetector->scoringHandles) {
 
-          if (hitVolume->GetName() == scoringHanlde) {
+G4int SteppingAction::Species(const G4ParticleDefinition* particle) {
 
-              G4double edepStep = step->GetTotalEnergyDeposit();
+    // indexed by the definition ID; ions are created during the run, so
+    // each definition is classified the first time it deposits
+    G4int id = particle->GetParticleDefinitionID();
+    if (id < 0) return DetectorResponse::GetSpecies(particle);
+    if (id >= static_cast<G4int>(fSpeciesTable.size())) fSpeciesTable.resize(id + 1, -1);
+    G4int& species = fSpeciesTable[id];
+    if (species < 0) species = DetectorResponse::GetSpecies(particle);
+    return species;
+}
 
 
-              if (edepStep > 0.) {
-                  fEventAction->AddEdep(hitVolume->GetName(), edepStep);
-              }
-              break;
-          }
-      }
+G4double SteppingAction::Light(const G4Step* step, G4int species, G4double edep) const {
+
+    const DetectorResponse* response = fDetector->GetResponse();
+
+    // a recoil absorbed by the fast simulation deposits its whole energy in
+    // one step: take the light of its whole slowing down from the tables
+    // prepared for the run instead
+    const G4VProcess* process = step->GetPostStepPoint()->GetProcessDefinedStep();
+    if (process && process->GetProcessType() == fParameterisation) {
+        return response->StoppingLight(step->GetTrack()->GetDefinition(),
+                                       step->GetPreStepPoint()->GetMaterial(), edep);
     }
+    const G4StepPoint* preStep = step->GetPreStepPoint();
+    return response->StepLight(step->GetTrack()->GetDefinition(), preStep->GetMaterial(),
+                               static_cast<DetectorResponse::Species>(species), edep, step->GetStepLength(),
+                               preStep->GetKineticEnergy(), step->GetPostStepPoint()->GetKineticEnergy());
+}
 
 
+G4double SteppingAction::PhotoElectrons(const G4Step* step, G4int index, G4double light) const {
 
+    const DetectorResponse* response = fDetector->GetResponse();
+    if (!response->UseLightCollection()) return 0.;
 
+    // emitted at the middle of the step, in the frame of the crystal
+    const G4StepPoint* preStep = step->GetPreStepPoint();
+    G4ThreeVector position = 0.5 * (preStep->GetPosition() + step->GetPostStepPoint()->GetPosition());
+    G4ThreeVector local = preStep->GetTouchable()->GetHistory()->GetTopTransform().TransformPoint(position);
+    return response->PhotoElectronMean(index, local, light);
+}
+
+
+void SteppingAction::ApplyKillPolicies(G4Track* track) {
 
+    // outside the envelope and moving away: only the world material is left
+    G4double margin = fPhysicsList->GetKillEnvelopeMargin();
+    G4double radius = fDetector->GetBoundingRadius();
+    if (margin >= 0. && radius > 0.) {
+        G4ThreeVector offset = track->GetPosition() - fDetector->GetBoundingCentre();
+        radius += margin;
+        if (offset.mag2() > radius * radius && offset.dot(track->GetMomentumDirection()) > 0.) {
+            track->SetTrackStatus(fStopAndKill);
+            fEventAction->CountKilled(EventAction::kKillEnvelope);
+            return;
+        }
+    }
 
+    G4double timeCut = fPhysicsList->GetKillTime();
+    if (timeCut > 0. && track->GetGlobalTime() - fEventAction->GetEmissionTime() > timeCut) {
+        track->SetTrackStatus(fStopAndKill);
+        fEventAction->CountKilled(EventAction::kKillTime);
+        return;
+    }
 
+    G4double floor = fPhysicsList->GetNeutronEnergyFloor();
+    if (floor > 0. && track->GetDefinition() == G4Neutron::Definition()
+        && track->GetKineticEnergy() < floor) {
+        track->SetTrackStatus(fStopAndKill);
+        fEventAction->CountKilled(EventAction::kKillEnergy);
+    }
 }
 
 